@@ -0,0 +1,181 @@
+#! /bin/bash
+
+# Latencia de punta a punta, desde un programa hasta los archivos de dots/ y
+# traversals/. Cada programa se ejecuta varias veces y se informan percentiles
+# de cada etapa (en milisegundos):
+#
+#   compile  bin/Compiler, hasta escribir Main.java.
+#   build    la compilación de Java.
+#   jvm      el arranque de la JVM sin ejecutar el programa (con Maven, el de
+#            Maven).
+#   run      la ejecución del programa, sin el arranque ni la escritura.
+#   io       la escritura de dots/ y traversals/, medida por Tree.java.
+#   total    compile + build + la ejecución completa.
+#
+# El camino "mvn" es el del compilador ("mvn clean compile" y "mvn exec:java");
+# "java" compila con javac y ejecuta con java, con las mismas dependencias.
+#
+# Uso: script/latency.sh [--runs <n>] [--warmup <n>] [--path mvn|java]
+#                        [--output <archivo.json>] [programa...]
+# Sin programas, se usan los de test/accept.
+
+set -e
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+DOMAIN="$ROOT/src/backend/domain-specific"
+POM="$DOMAIN/pom.xml"
+MAIN="$DOMAIN/src/main/java/Main.java"
+STAGES="compile build jvm run io total"
+
+RUNS=5
+WARMUP=1
+EXECUTION=mvn
+OUTPUT=""
+PROGRAMS=()
+while [ $# -gt 0 ]; do
+	case "$1" in
+		--runs) RUNS="$2"; shift 2 ;;
+		--warmup) WARMUP="$2"; shift 2 ;;
+		--path) EXECUTION="$2"; shift 2 ;;
+		--output) OUTPUT="$(cd "$(dirname "$2")" && pwd)/$(basename "$2")"; shift 2 ;;
+		*) PROGRAMS+=("$(cd "$(dirname "$1")" && pwd)/$(basename "$1")"); shift ;;
+	esac
+done
+if [ ${#PROGRAMS[@]} -eq 0 ]; then
+	PROGRAMS=("$ROOT"/test/accept/*)
+fi
+if [ "$EXECUTION" != "mvn" ] && [ "$EXECUTION" != "java" ]; then
+	echo "Camino desconocido: '$EXECUTION' (mvn o java)." >&2
+	exit 1
+fi
+if [ ! -x "$ROOT/bin/Compiler" ]; then
+	echo "Falta bin/Compiler: ejecute antes script/build.sh." >&2
+	exit 1
+fi
+
+WORK="$(mktemp -d)"
+LOG="$WORK/log"
+IO="$WORK/io"
+# Main.java se genera dentro del proyecto de Maven, como lo hace el compilador;
+# si no existía, no se deja.
+KEEP_MAIN=false
+[ -f "$MAIN" ] && KEEP_MAIN=true
+function cleanup() {
+	rm -rf "$WORK"
+	$KEEP_MAIN || rm -f "$MAIN"
+}
+trap cleanup EXIT
+
+# Dependencias de Java (graphviz-java), resueltas una sola vez.
+if [ "$EXECUTION" == "java" ]; then
+	mvn -q -f "$POM" dependency:build-classpath -Dmdep.outputFile="$WORK/classpath" >>"$LOG" 2>&1
+	CLASSPATH_FILE="$(cat "$WORK/classpath")"
+	CLASSES="$WORK/classes"
+fi
+
+# Microsegundos de pared que tarda un comando. Si falla, se aborta mostrando
+# su salida de errores.
+function measure() {
+	local start end
+	start=$(date +%s%N)
+	if ! "$@" >/dev/null 2>>"$LOG"; then
+		echo "Fallo: $*" >&2
+		tail -n 20 "$LOG" >&2
+		exit 1
+	fi
+	end=$(date +%s%N)
+	echo $(( (end - start) / 1000 ))
+}
+
+function build() {
+	if [ "$EXECUTION" == "mvn" ]; then
+		mvn -q -f "$POM" clean compile
+	else
+		rm -rf "$CLASSES"
+		javac -d "$CLASSES" -cp "$CLASSPATH_FILE" "$DOMAIN"/src/main/java/*.java
+	fi
+}
+
+function boot() {
+	if [ "$EXECUTION" == "mvn" ]; then
+		mvn -q -f "$POM" --version
+	else
+		java -cp "$CLASSES:$CLASSPATH_FILE" -version
+	fi
+}
+
+function execute() {
+	if [ "$EXECUTION" == "mvn" ]; then
+		mvn -q -f "$POM" exec:java -Dexec.mainClass="Main" -Dtla.ioReport="$IO"
+	else
+		java -Dtla.ioReport="$IO" -cp "$CLASSES:$CLASSPATH_FILE" Main
+	fi
+}
+
+# Una ejecución completa de "$1". Si "$2" no está vacío, agrega las muestras
+# a "$2.<etapa>".
+function run() {
+	local compile build jvm execution io
+	# El programa escribe en el directorio actual; se empieza siempre vacío.
+	rm -rf "$WORK/out" "$IO"
+	mkdir -p "$WORK/out/dots" "$WORK/out/traversals"
+	cd "$WORK/out"
+	compile=$(measure "$ROOT/bin/Compiler" --output "$MAIN" "$1")
+	build=$(measure build)
+	jvm=$(measure boot)
+	execution=$(measure execute)
+	# Sin árboles, Tree.java no se carga y no informa nada.
+	io=0
+	[ -f "$IO" ] && io=$(( $(cat "$IO") / 1000 ))
+	[ -z "$2" ] && return
+	echo "$compile" >>"$2.compile"
+	echo "$build" >>"$2.build"
+	echo "$jvm" >>"$2.jvm"
+	echo $(( execution - jvm - io > 0 ? execution - jvm - io : 0 )) >>"$2.run"
+	echo "$io" >>"$2.io"
+	echo $(( compile + build + execution )) >>"$2.total"
+}
+
+# Percentiles 50, 90 y 99 (nearest-rank), máximo y media de las muestras de
+# "$1", en milisegundos: "p50 p90 p99 max mean".
+function summarize() {
+	sort -n "$1" | awk '{ v[NR] = $1; sum += $1 }
+		function rank(p) { i = int(p * NR / 100 + 0.999999); return v[i < 1 ? 1 : i] / 1000 }
+		END { printf "%.1f %.1f %.1f %.1f %.1f\n", rank(50), rank(90), rank(99), v[NR] / 1000, sum / NR / 1000 }'
+}
+
+JSON="{\n  \"path\": \"$EXECUTION\",\n  \"runs\": $RUNS,\n  \"workloads\": ["
+SEPARATOR=""
+printf "%-28s %-8s %9s %9s %9s %9s %9s\n" "programa" "etapa" "p50" "p90" "p99" "max" "media"
+for program in "${PROGRAMS[@]}" "todos"; do
+	name="$(basename "$program")"
+	if [ "$program" == "todos" ]; then
+		# Las muestras de todos los programas juntas.
+		for stage in $STAGES; do
+			cat "$WORK"/samples.*."$stage" >"$WORK/all.$stage"
+		done
+		samples="$WORK/all"
+	else
+		samples="$WORK/samples.$name"
+		for (( i = 0; i < WARMUP; ++i )); do
+			run "$program" ""
+		done
+		for (( i = 0; i < RUNS; ++i )); do
+			run "$program" "$samples"
+		done
+	fi
+	JSON="$JSON$SEPARATOR\n    {\"program\": \"$name\", \"stages\": {"
+	STAGE_SEPARATOR=""
+	for stage in $STAGES; do
+		read -r p50 p90 p99 max mean <<< "$(summarize "$samples.$stage")"
+		printf "%-28s %-8s %9s %9s %9s %9s %9s\n" "$name" "$stage" "$p50" "$p90" "$p99" "$max" "$mean"
+		JSON="$JSON$STAGE_SEPARATOR\n      \"$stage\": {\"p50_ms\": $p50, \"p90_ms\": $p90, \"p99_ms\": $p99, \"max_ms\": $max, \"mean_ms\": $mean}"
+		STAGE_SEPARATOR=","
+	done
+	JSON="$JSON\n    }}"
+	SEPARATOR=","
+done
+JSON="$JSON\n  ]\n}"
+
+if [ -n "$OUTPUT" ]; then
+	echo -e "$JSON" >"$OUTPUT"
+fi
@@ -0,0 +1,43 @@
+#! /bin/bash
+
+# Construye bin/Compiler con LTO y optimización guiada por perfil: compila una
+# versión instrumentada, la entrena con los programas de test/corpus y
+# test/accept y con programas sintéticos grandes (bin/Benchmark), y la
+# recompila usando el perfil obtenido.
+
+set -e
+ROOT="$(dirname "$0")"
+
+echo "Relocating script to '$ROOT'..."
+cd "$ROOT/.."
+
+PROFILES="$(pwd)/bin/pgo"
+TRAINING="$(mktemp -d)"
+trap 'rm -rf "$TRAINING"' EXIT
+rm -rf "$PROFILES"
+
+echo "Building the instrumented compiler..."
+cmake -S . -B bin -DLTO=ON -DPGO=GENERATE -DPGO_DIR="$PROFILES"
+cmake --build bin
+
+echo "Training..."
+# Compilaciones completas, en paralelo y de a una (con la salida en memoria).
+for i in $(seq 1 20); do
+	./bin/Compiler --batch --output "$TRAINING" test/corpus test/accept >/dev/null 2>&1
+done
+for program in test/corpus/*; do
+	./bin/Compiler --output "$TRAINING/Main.java" "$program" >/dev/null 2>&1
+done
+# Programas grandes de cada forma.
+./bin/Benchmark --repetitions 2 --output "$TRAINING/benchmark.json" >/dev/null 2>&1
+
+# Clang deja perfiles crudos que hay que unir; GCC los escribe ya listos.
+if ls "$PROFILES"/*.profraw >/dev/null 2>&1; then
+	llvm-profdata merge -output="$PROFILES/default.profdata" "$PROFILES"/*.profraw
+fi
+
+echo "Building the optimized compiler..."
+cmake -S . -B bin -DPGO=USE
+cmake --build bin
+
+echo "All done."
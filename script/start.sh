@@ -6,4 +6,4 @@ ROOT="$(dirname "$0")"
 echo "Relocating script to '$ROOT'..."
 cd "$ROOT/.."
 
-cat "$1" | ./bin/Compiler
+./bin/Compiler "$1"
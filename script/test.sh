@@ -9,12 +9,27 @@ GREEN='\033[0;32m'
 RED='\033[0;31m'
 OFF='\033[0m'
 
+# Todos los casos se compilan en un único proceso, en paralelo. El resultado
+# de cada uno sale por la salida estándar, con un formato fijo; los mensajes
+# del logger (salida de errores) se descartan.
+RESULTS="$(./bin/Compiler --batch --test test/accept test/reject 2>/dev/null)"
+ACCEPTED="$(grep -E '^Aceptado: ' <<< "$RESULTS" | sed -E 's/^Aceptado: //')"
+REJECTED_LINES="$(grep -E '^Rechazado \(estado [0-9]+' <<< "$RESULTS")"
+
+# Estado con el que terminó la compilación de un caso (0 si fue aceptado).
+function status() {
+	if grep -qxF "$1" <<< "$ACCEPTED"; then
+		echo 0
+	else
+		grep -F "): $1: " <<< "$REJECTED_LINES" | sed -E 's/^Rechazado \(estado ([0-9]+).*/\1/'
+	fi
+}
+
 echo "Compiler should accept..."
 echo ""
 
 for test in $(ls test/accept/); do
-	cat "test/accept/$test" | ./bin/Compiler --test >/dev/null 2>&1
-	RESULT="$?"
+	RESULT="$(status "test/accept/$test")"
 	if [ "$RESULT" == "0" ]; then
 		echo -e "    $test, ${GREEN}and it does${OFF} (status $RESULT)"
 	else
@@ -27,8 +42,7 @@ echo "Compiler should reject..."
 echo ""
 
 for test in $(ls test/reject/); do
-	cat "test/reject/$test" | ./bin/Compiler --test >/dev/null 2>&1
-	RESULT="$?"
+	RESULT="$(status "test/reject/$test")"
 	if [ "$RESULT" != "0" ]; then
 		echo -e "    $test, ${GREEN}and it does${OFF} (status $RESULT)"
 	else
@@ -1,5 +1,7 @@
 #include "../support/logger.h"
 #include "generator.h"
+#include <pthread.h>
+#include <stdlib.h>
 
 /**
  * Implementación de "generator.h".
@@ -7,154 +9,428 @@
 
 // Output language is Java
 
-void GeneratorProgram(Program *program) {
+/*
+ * El recorrido no es recursivo: cada nodo, al expandirse, emite lo que puede
+ * en el momento y apila el resto (hijos y texto pendiente) en orden inverso.
+ * La pila solo crece con la profundidad de anidamiento, y vive en el heap, de
+ * modo que programas largos o muy anidados no agotan la pila del proceso.
+ */
+
+typedef enum {
+    TEXT_TASK,
+    SYMBOL_TASK,
+    STATEMENT_LIST_TASK,
+    BLOCK_TASK,
+    EXPRESSION_TASK
+} TaskType;
+
+typedef struct {
+    TaskType type;
+    union {
+        const char *text;
+        SymbolId symbol;
+        StatementList statements;
+        Block *block;
+        Expression *expression;
+    };
+} Task;
+
+typedef struct {
+    Generator *generator;
+    Task *tasks;
+    size_t size;
+    size_t capacity;
+} TaskStack;
+
+#define INITIAL_STACK_SIZE 64
+
+// Con menos sentencias de primer nivel no compensa repartir la generación.
+#define PARALLEL_MIN_STATEMENTS 4096
+
+// Fragmentos por hilo: más de uno, para que un fragmento con sentencias
+// costosas no deje al resto de los hilos esperando.
+#define CHUNKS_PER_WORKER 4
+
+/*
+ * Generación en paralelo: las sentencias de primer nivel se reparten en
+ * fragmentos consecutivos, cada uno se genera en su propio buffer y luego se
+ * concatenan en orden. Los hilos toman el próximo fragmento libre con un
+ * contador atómico.
+ */
+typedef struct {
+    StatementList first;
+    size_t count;
+    outputBufferADT output;
+    bool failed;
+} Chunk;
+
+typedef struct {
+    Generator *generator;
+    Chunk *chunks;
+    size_t chunkCount;
+    size_t next;
+} ChunkQueue;
+
+// Los nombres se obtienen indexando directamente el arreglo de símbolos.
+static inline const char *SymbolName(Generator *generator, SymbolId symbol) {
+    return symbolTableGet(generator->symbols, symbol)->varname;
+}
+
+bool GeneratorFailed(Generator *generator) {
+    return generator->failed || outputBufferFailed(generator->output);
+}
+
+// Sin memoria para la pila, la generación queda fallida y "Run" se detiene.
+static void Push(TaskStack *stack, Task task) {
+    if (stack->generator->failed) {
+        return;
+    }
+    if (stack->size == stack->capacity) {
+        size_t capacity = stack->capacity == 0 ? INITIAL_STACK_SIZE : stack->capacity * 2;
+        Task *tasks = realloc(stack->tasks, capacity * sizeof(Task));
+        if (tasks == NULL) {
+            LogError("No hay memoria para generar el codigo.");
+            stack->generator->failed = true;
+            return;
+        }
+        stack->tasks = tasks;
+        stack->capacity = capacity;
+    }
+    stack->tasks[stack->size++] = task;
+}
+
+static inline void PushText(TaskStack *stack, const char *text) {
+    Push(stack, (Task) {.type = TEXT_TASK, .text = text});
+}
+
+static inline void PushSymbol(TaskStack *stack, SymbolId symbol) {
+    Push(stack, (Task) {.type = SYMBOL_TASK, .symbol = symbol});
+}
+
+static inline void PushStatements(TaskStack *stack, StatementList statements) {
+    if (statements != NULL) {
+        Push(stack, (Task) {.type = STATEMENT_LIST_TASK, .statements = statements});
+    }
+}
+
+static inline void PushBlock(TaskStack *stack, Block *block) {
+    Push(stack, (Task) {.type = BLOCK_TASK, .block = block});
+}
+
+static inline void PushExpression(TaskStack *stack, Expression *expression) {
+    Push(stack, (Task) {.type = EXPRESSION_TASK, .expression = expression});
+}
+
+static void ExpandStatement(TaskStack *stack, Statement *statement);
+static void ExpandAssignment(TaskStack *stack, Assignment *assignment);
+static void ExpandFunctionCall(TaskStack *stack, FunctionCall *functionCall);
+static void ExpandDeclaration(TaskStack *stack, Declaration *declaration);
+static void ExpandExpression(TaskStack *stack, Expression *expression);
+
+static void Run(TaskStack *stack) {
+    while (stack->size > 0 && !GeneratorFailed(stack->generator)) {
+        Task task = stack->tasks[--stack->size];
+        switch (task.type) {
+            case TEXT_TASK:
+                OutputString(stack->generator, task.text);
+                break;
+            case SYMBOL_TASK:
+                OutputString(stack->generator, SymbolName(stack->generator, task.symbol));
+                break;
+            case STATEMENT_LIST_TASK:
+                // El resto de la lista queda debajo de la sentencia actual.
+                PushStatements(stack, task.statements->next);
+                ExpandStatement(stack, &task.statements->statement);
+                break;
+            case BLOCK_TASK:
+                OutputString(stack->generator, "{\n");
+                PushText(stack, "}\n");
+                PushStatements(stack, task.block->statements);
+                break;
+            case EXPRESSION_TASK:
+                ExpandExpression(stack, task.expression);
+                break;
+        }
+    }
+}
 
-    Output("import java.io.IOException;\n");
-    Output("public class Main {\n");
-    Output("public static void main(String[] args) throws IOException {\n");
-    GeneratorStatementList(program->statements);
-    Output("}\n");
-    Output("}\n");
+static void GenerateChunk(Generator *generator, Chunk *chunk) {
+    Generator chunkGenerator = {.output = chunk->output, .symbols = generator->symbols};
+    TaskStack stack = {.generator = &chunkGenerator};
+    StatementList statements = chunk->first;
+    for (size_t i = 0; i < chunk->count && !GeneratorFailed(&chunkGenerator); ++i, statements = statements->next) {
+        ExpandStatement(&stack, &statements->statement);
+        Run(&stack);
+    }
+    chunk->failed = GeneratorFailed(&chunkGenerator);
+    free(stack.tasks);
 }
 
-void GeneratorStatementList(StatementList statementList) {
-    StatementList current = statementList;
-    while (current != NULL) {
-        GeneratorStatement(current->statement);
-        current = current->next;
+static void *GenerateChunks(void *argument) {
+    ChunkQueue *queue = argument;
+    for (;;) {
+        size_t chunk = __atomic_fetch_add(&queue->next, 1, __ATOMIC_RELAXED);
+        if (chunk >= queue->chunkCount) {
+            return NULL;
+        }
+        GenerateChunk(queue->generator, &queue->chunks[chunk]);
     }
 }
 
-void GeneratorStatement(Statement *statement) {
+// Devuelve false si no se pudo preparar la generación en paralelo, sin
+// haber escrito nada.
+static bool GenerateInParallel(Generator *generator, StatementList statementList) {
+    size_t statementCount = 0;
+    for (StatementList node = statementList; node != NULL; node = node->next) {
+        statementCount++;
+    }
+    if (generator->workers <= 1 || statementCount < PARALLEL_MIN_STATEMENTS) {
+        return false;
+    }
+
+    size_t chunkCount = (size_t) generator->workers * CHUNKS_PER_WORKER;
+    size_t chunkSize = (statementCount + chunkCount - 1) / chunkCount;
+    chunkCount = (statementCount + chunkSize - 1) / chunkSize;
+    Chunk *chunks = calloc(chunkCount, sizeof(Chunk));
+    pthread_t *threads = calloc(generator->workers - 1, sizeof(pthread_t));
+    bool prepared = chunks != NULL && threads != NULL;
+    StatementList node = statementList;
+    for (size_t i = 0; prepared && i < chunkCount; ++i) {
+        chunks[i].first = node;
+        chunks[i].count = i + 1 < chunkCount ? chunkSize : statementCount - i * chunkSize;
+        chunks[i].output = outputBufferInit(0);
+        prepared = chunks[i].output != NULL;
+        for (size_t j = 0; j < chunks[i].count; ++j) {
+            node = node->next;
+        }
+    }
+
+    if (prepared) {
+        // El hilo que llama también genera fragmentos.
+        ChunkQueue queue = {.generator = generator, .chunks = chunks, .chunkCount = chunkCount};
+        int started = 0;
+        while (started < generator->workers - 1 && pthread_create(&threads[started], NULL, GenerateChunks, &queue) == 0) {
+            started++;
+        }
+        GenerateChunks(&queue);
+        for (int i = 0; i < started; ++i) {
+            pthread_join(threads[i], NULL);
+        }
+        for (size_t i = 0; i < chunkCount; ++i) {
+            generator->failed |= chunks[i].failed;
+            outputBufferWrite(generator->output, outputBufferData(chunks[i].output), outputBufferLength(chunks[i].output));
+        }
+    }
+
+    for (size_t i = 0; chunks != NULL && i < chunkCount; ++i) {
+        outputBufferDestroy(chunks[i].output);
+    }
+    free(chunks);
+    free(threads);
+    return prepared;
+}
+
+void GeneratorProgram(Generator *generator, Program *program) {
+    traceBegin(generator->trace, "Encabezado");
+    GeneratorProgramBegin(generator);
+    traceEnd(generator->trace);
+    traceBegin(generator->trace, "Sentencias");
+    GeneratorStatementList(generator, program->statements);
+    traceEnd(generator->trace);
+    traceBegin(generator->trace, "Cierre");
+    GeneratorProgramEnd(generator);
+    traceEnd(generator->trace);
+}
+
+void GeneratorProgramBegin(Generator *generator) {
+    OutputString(generator, "import java.io.IOException;\n");
+    OutputString(generator, "public class Main {\n");
+    OutputString(generator, "public static void main(String[] args) throws IOException {\n");
+}
+
+void GeneratorProgramEnd(Generator *generator) {
+    OutputString(generator, "}\n");
+    OutputString(generator, "}\n");
+}
+
+void GeneratorStatementList(Generator *generator, StatementList statementList) {
+    if (GenerateInParallel(generator, statementList)) {
+        return;
+    }
+    TaskStack stack = {.generator = generator};
+    PushStatements(&stack, statementList);
+    Run(&stack);
+    free(stack.tasks);
+}
+
+void GeneratorStatement(Generator *generator, Statement *statement) {
+    TaskStack stack = {.generator = generator};
+    ExpandStatement(&stack, statement);
+    Run(&stack);
+    free(stack.tasks);
+}
+
+void GeneratorExpression(Generator *generator, Expression *expression) {
+    TaskStack stack = {.generator = generator};
+    PushExpression(&stack, expression);
+    Run(&stack);
+    free(stack.tasks);
+}
+
+static void ExpandStatement(TaskStack *stack, Statement *statement) {
     switch (statement->type) {
         case IF_STATEMENT:
-            GeneratorIfStatement(statement->ifStatement);
+            OutputString(stack->generator, "if (");
+            if (statement->ifStatement->type == IF_ELSE_TYPE) {
+                PushBlock(stack, statement->ifStatement->blockElse);
+                PushText(stack, "else");
+            }
+            PushBlock(stack, statement->ifStatement->blockIf);
+            PushText(stack, ")");
+            PushExpression(stack, statement->ifStatement->condition);
             break;
         case FOR_STATEMENT:
-            GeneratorForStatement(statement->forStatement);
+            OutputString(stack->generator, "for (int ");
+            OutputString(stack->generator, SymbolName(stack->generator, statement->forStatement->symbol));
+            OutputString(stack->generator, " = ");
+            PushBlock(stack, statement->forStatement->block);
+            PushText(stack, "++)");
+            PushSymbol(stack, statement->forStatement->symbol);
+            PushText(stack, "; ");
+            PushExpression(stack, statement->forStatement->range->expressionRight);
+            PushText(stack, " < ");
+            PushSymbol(stack, statement->forStatement->symbol);
+            PushText(stack, "; ");
+            PushExpression(stack, statement->forStatement->range->expressionLeft);
             break;
         case WHILE_STATEMENT:
-            GeneratorWhileStatement(statement->whileStatement);
+            OutputString(stack->generator, "while (");
+            PushBlock(stack, statement->whileStatement->block);
+            PushText(stack, ")");
+            PushExpression(stack, statement->whileStatement->condition);
             break;
         case FUNCTION_CALL_STATEMENT:
-            GeneratorFunctionCall(statement->functionCall);
+            ExpandFunctionCall(stack, statement->functionCall);
             break;
         case DECLARATION_STATEMENT:
-            GeneratorDeclaration(statement->declaration);
+            ExpandDeclaration(stack, statement->declaration);
             break;
         case ASSIGNMENT_STATEMENT:
-            GeneratorAssignment(statement->assignment);
-            Output(";\n");
+            PushText(stack, ";\n");
+            ExpandAssignment(stack, statement->assignment);
             break;
     }
 }
 
-void GeneratorAssignment(Assignment *assignment) {
-    Output("%s = ", assignment->varname);
+static void ExpandAssignment(TaskStack *stack, Assignment *assignment) {
+    OutputString(stack->generator, SymbolName(stack->generator, assignment->symbol));
+    OutputString(stack->generator, " = ");
+    // Se asigna una expresión o el resultado de una llamada, nunca ambos.
     if (assignment->expression != NULL) {
-        GeneratorExpression(assignment->expression);
-    } 
-
-    if (assignment->functionCall != NULL) {
-        GeneratorFunctionCall(assignment->functionCall);
+        PushExpression(stack, assignment->expression);
+    } else if (assignment->functionCall != NULL) {
+        ExpandFunctionCall(stack, assignment->functionCall);
     }
 }
 
-void GeneratorFunctionCall(FunctionCall *functionCall) {
+static void ExpandFunctionCall(TaskStack *stack, FunctionCall *functionCall) {
 
     if (functionCall->type == ADD_TREE_CALL) {
-        GeneratorDeclaration(functionCall->declaration);
-        Output("%s.addTree(%s);\n", functionCall->declaration->varname, functionCall->varname);
+        PushText(stack, ");\n");
+        PushSymbol(stack, functionCall->symbol);
+        PushText(stack, ".addTree(");
+        PushSymbol(stack, functionCall->declaration->symbol);
+        ExpandDeclaration(stack, functionCall->declaration);
         return;
     }
 
-    Output("%s.", functionCall->varname);
+    OutputString(stack->generator, SymbolName(stack->generator, functionCall->symbol));
+    OutputString(stack->generator, ".");
 
+    // Las llamadas con argumento dejan la expresión apilada.
+    const char *call = NULL;
     switch (functionCall->type) {
         case PRINT_CALL:
-            Output("draw()");
+            OutputString(stack->generator, "draw()");
             break;
         case MAX_CALL:
-            Output("max()");
+            OutputString(stack->generator, "max()");
             break;
         case MIN_CALL:
-            Output("min()");
+            OutputString(stack->generator, "min()");
             break;
         case ROOT_CALL:
-            Output("printRoot()");
+            OutputString(stack->generator, "printRoot()");
             break;
         case HEIGHT_CALL:
-            Output("height()");
+            OutputString(stack->generator, "height()");
             break;
         case INSERT_CALL:
-            Output("insert(");
-            GeneratorExpression(functionCall->expression);
-            Output(")");
+            call = "insert(";
             break;
         case REMOVE_CALL:
-            Output("remove(");
-            GeneratorExpression(functionCall->expression);
-            Output(")");
+            call = "remove(";
             break;
         case INORDER_CALL:
-            Output("inorder()");
+            OutputString(stack->generator, "inorder()");
             break;
         case POSTORDER_CALL:
-            Output("postorder()");
+            OutputString(stack->generator, "postorder()");
             break;
         case PREORDER_CALL:
-            Output("preorder()");
+            OutputString(stack->generator, "preorder()");
             break;
         case REDUCE_EVEN_CALL:
-            Output("reduce(x -> x %c 2 == 0)", '%');
+            OutputString(stack->generator, "reduce(x -> x % 2 == 0)");
             break;
         case REDUCE_ODD_CALL:
-            Output("reduce(x -> x %c 2 != 0)", '%');
+            OutputString(stack->generator, "reduce(x -> x % 2 != 0)");
             break;
         case FIND_CALL:
-            Output("find(");
-            GeneratorExpression(functionCall->expression);
-            Output(")");
+            call = "find(";
             break;
         case PRESENT_CALL:
-            Output("isPresent(");
-            GeneratorExpression(functionCall->expression);
-            Output(")");
+            call = "isPresent(";
             break;
         default:
             break;
     }
 
-    Output(";\n");
+    if (call == NULL) {
+        OutputString(stack->generator, ";\n");
+        return;
+    }
+    OutputString(stack->generator, call);
+    PushText(stack, ");\n");
+    PushExpression(stack, functionCall->expression);
 }
 
-void GeneratorDeclaration(Declaration *declaration) {
+static void ExpandDeclaration(TaskStack *stack, Declaration *declaration) {
     switch (declaration->type) {
-        case RBT_DECLARATION:
-            Output("Tree<Integer> %s = new RBT<>();\n", declaration->varname);
-            break;
-        case AVL_DECLARATION:
-            Output("Tree<Integer> %s = new AVL<>();\n", declaration->varname);
-            break;
-        case BST_DECLARATION:
-            Output("Tree<Integer> %s = new BST<>();\n", declaration->varname);
-            break;
-        case INT_DECLARATION:
-            Output("int ");
+        case VAR_RBT:
+            OutputString(stack->generator, "Tree<Integer> ");
+            OutputString(stack->generator, SymbolName(stack->generator, declaration->symbol));
+            OutputString(stack->generator, " = new RBT<>();\n");
+            break;
+        case VAR_AVL:
+            OutputString(stack->generator, "Tree<Integer> ");
+            OutputString(stack->generator, SymbolName(stack->generator, declaration->symbol));
+            OutputString(stack->generator, " = new AVL<>();\n");
+            break;
+        case VAR_BST:
+            OutputString(stack->generator, "Tree<Integer> ");
+            OutputString(stack->generator, SymbolName(stack->generator, declaration->symbol));
+            OutputString(stack->generator, " = new BST<>();\n");
+            break;
+        case VAR_INT:
+        case VAR_BOOL:
+            OutputString(stack->generator, declaration->type == VAR_INT ? "int " : "boolean ");
             if (declaration->assignment != NULL) {
-                GeneratorAssignment(declaration->assignment);
-                Output(";\n");
+                PushText(stack, ";\n");
+                ExpandAssignment(stack, declaration->assignment);
             } else {
-                Output("%s;\n", declaration->varname);
-            }
-            break;
-        case BOOL_DECLARATION:
-            Output("boolean ");
-            if (declaration->assignment != NULL) {
-                GeneratorAssignment(declaration->assignment);
-                Output(";\n");
-            } else {
-                Output("%s;\n", declaration->varname);
+                OutputString(stack->generator, SymbolName(stack->generator, declaration->symbol));
+                OutputString(stack->generator, ";\n");
             }
             break;
         default:
@@ -162,158 +438,79 @@ void GeneratorDeclaration(Declaration *declaration) {
     }
 }
 
-void GeneratorWhileStatement(WhileStatement *whileStatement) {
-    Output("while (");
-    GeneratorExpression(whileStatement->condition);
-    Output(")");
-    GeneratorBlock(whileStatement->block);
-}
-
-void GeneratorForStatement(ForStatement *forStatement) {
-    Output("for (int %s = ", forStatement->varname);
-    GeneratorExpression(forStatement->range->expressionLeft);
-    Output("; %s < ", forStatement->varname);
-    GeneratorExpression(forStatement->range->expressionRight);
-    Output("; %s++)", forStatement->varname);
-    GeneratorBlock(forStatement->block);
-
-}
-
-void GeneratorIfStatement(IfStatement *ifStatement) {
-    Output("if (");
-    GeneratorExpression(ifStatement->condition);
-    Output(")");
-    GeneratorBlock(ifStatement->blockIf);
-
-    if (ifStatement->type == IF_ELSE_TYPE) {
-        Output("else");
-        GeneratorBlock(ifStatement->blockElse);
+static const char *BinaryOperator(ExpressionType type) {
+    switch (type) {
+        case ADDITION_EXPRESSION: return " + ";
+        case SUBTRACTION_EXPRESSION: return " - ";
+        case MULTIPLICATION_EXPRESSION: return " * ";
+        case DIVISION_EXPRESSION: return " / ";
+        case MODULUS_EXPRESSION: return " % ";
+        case AND_EXPRESSION: return " && ";
+        case OR_EXPRESSION: return " || ";
+        case EQUALS_EXPRESSION: return " == ";
+        case NOT_EQUALS_EXPRESSION: return " != ";
+        case LESS_THAN_EXPRESSION: return " < ";
+        case LEES_EQUAL_EXPRESSION: return " <= ";
+        case GREATER_THAN_EXPRESSION: return " > ";
+        case GREATER_EQUAL_EXPRESSION: return " >= ";
+        default: return NULL;
     }
 }
 
-void GeneratorBlock(Block *block) {
-    Output("{\n");
-    GeneratorStatementList(block->statements);
-    Output("}\n");
-}
-
-void GeneratorExpression(Expression *expression) {
-    if (expression->type == MODULUS_EXPRESSION) {
-        printf("MODULUS\n");
-    }
+static void ExpandExpression(TaskStack *stack, Expression *expression) {
+    const char *operator;
     switch (expression->type) {
-        case ADDITION_EXPRESSION:
-            GeneratorExpression(expression->leftExpression);
-            Output(" + ");
-            GeneratorExpression(expression->rightExpression);
-            break;
-        case SUBTRACTION_EXPRESSION:
-            GeneratorExpression(expression->leftExpression);
-            Output(" - ");
-            GeneratorExpression(expression->rightExpression);
-            break;
-        case MULTIPLICATION_EXPRESSION:
-            GeneratorExpression(expression->leftExpression);
-            Output(" * ");
-            GeneratorExpression(expression->rightExpression);
-            break;
-        case DIVISION_EXPRESSION:
-            GeneratorExpression(expression->leftExpression);
-            Output(" / ");
-            GeneratorExpression(expression->rightExpression);
-            break;
-        case MODULUS_EXPRESSION:
-            GeneratorExpression(expression->leftExpression);
-            Output(" %c ", '%');
-            GeneratorExpression(expression->rightExpression);
-            break;
-        case AND_EXPRESSION:
-            GeneratorExpression(expression->leftExpression);
-            Output(" && ");
-            GeneratorExpression(expression->rightExpression);
-            break;
         case NOT_EXPRESSION:
-            Output("!");
-            GeneratorExpression(expression->leftExpression);
-            break;
-        case OR_EXPRESSION:
-            GeneratorExpression(expression->leftExpression);
-            Output(" || ");
-            GeneratorExpression(expression->rightExpression);
-            break;
-        case EQUALS_EXPRESSION:
-            GeneratorExpression(expression->leftExpression);
-            Output(" == ");
-            GeneratorExpression(expression->rightExpression);
-            break;
-        case NOT_EQUALS_EXPRESSION:
-            GeneratorExpression(expression->leftExpression);
-            Output(" != ");
-            GeneratorExpression(expression->rightExpression);
-            break;
-        case LESS_THAN_EXPRESSION:
-            GeneratorExpression(expression->leftExpression);
-            Output(" < ");
-            GeneratorExpression(expression->rightExpression);
-            break;
-        case LEES_EQUAL_EXPRESSION:
-            GeneratorExpression(expression->leftExpression);
-            Output(" <= ");
-            GeneratorExpression(expression->rightExpression);
-            break;
-        case GREATER_THAN_EXPRESSION:
-            GeneratorExpression(expression->leftExpression);
-            Output(" > ");
-            GeneratorExpression(expression->rightExpression);
-            break;
-        case GREATER_EQUAL_EXPRESSION:
-            GeneratorExpression(expression->leftExpression);
-            Output(" >= ");
-            GeneratorExpression(expression->rightExpression);
+            OutputString(stack->generator, "!");
+            PushExpression(stack, expression->leftExpression);
             break;
         case FACTOR_EXPRESSION:
-            GeneratorFactor(expression->factor);
+            switch (expression->factor.type) {
+                case CONSTANT_FACTOR:
+                    GeneratorConstant(stack->generator, &expression->factor.constant);
+                    break;
+                case VARIABLE_FACTOR:
+                    OutputString(stack->generator, SymbolName(stack->generator, expression->factor.symbol));
+                    break;
+                case EXPRESSION_FACTOR:
+                    OutputString(stack->generator, "(");
+                    PushText(stack, ")");
+                    PushExpression(stack, expression->factor.expression);
+                    break;
+            }
             break;
         default:
+            operator = BinaryOperator(expression->type);
+            if (operator != NULL) {
+                PushExpression(stack, expression->rightExpression);
+                PushText(stack, operator);
+                PushExpression(stack, expression->leftExpression);
+            }
             break;
     }
 }
 
-void GeneratorFactor(Factor *factor) {
-    switch (factor->type) {
-        case CONSTANT_FACTOR:
-            GeneratorConstant(factor->constant);
-            break;
-        case VARIABLE_FACTOR:
-            Output("%s", factor->varname);
-            break;
-        case EXPRESSION_FACTOR:
-            Output("(");
-            GeneratorExpression(factor->expression);
-            Output(")");
-            break;
-    }
-}
-
-void GeneratorConstant(Constant *constant) {
+void GeneratorConstant(Generator *generator, Constant *constant) {
     if (constant->type == INT_CONSTANT) {
-        Output("%d", constant->intValue);
+        OutputInteger(generator, constant->intValue);
     } else {
-        Output("%s", constant->boolValue ? "true" : "false");
+        OutputString(generator, constant->boolValue ? "true" : "false");
     }
 }
 
 #include <stdarg.h>
 
-static FILE *outputFile;
-
-void SetOutputFile(FILE *file) {
-    outputFile = file;
-}
-
-void Output(char *format, ...) {
+void Output(Generator *generator, char *format, ...) {
     va_list args;
     va_start(args, format);
-    vfprintf(outputFile, format, args);
+    outputBufferFormatList(generator->output, format, args);
     va_end(args);
 }
+
+void OutputString(Generator *generator, const char *string) {
+    outputBufferString(generator->output, string);
+}
+
+void OutputInteger(Generator *generator, int value) {
+    outputBufferInteger(generator->output, value);
+}
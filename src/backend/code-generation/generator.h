@@ -2,38 +2,52 @@
 #define GENERATOR_HEADER
 
 #include "../semantic-analysis/abstract-syntax-tree.h"
-#include <stdio.h>
+#include "../support/output-buffer.h"
+#include "../support/trace.h"
 
-void Output(char *format, ...);
+/**
+ * Una generación escribe en su propio buffer y solo lee la tabla de símbolos,
+ * así que varias pueden correr a la vez sobre compilaciones distintas.
+ *
+ * Con "workers" mayor a 1, "GeneratorStatementList" reparte las sentencias de
+ * una lista larga entre esa cantidad de hilos; el resultado es idéntico al de
+ * la generación secuencial.
+ */
+typedef struct {
+    outputBufferADT output;
+    symbolTableADT symbols;
+    int workers;
+    // Si no es NULL, "GeneratorProgram" mide cada una de sus partes.
+    traceADT trace;
+    // Faltó memoria: la generación se detuvo y la salida está incompleta.
+    bool failed;
+} Generator;
 
-void SetOutputFile(FILE *file);
+// Indica si la generación (o su buffer de salida) se quedó sin memoria.
+bool GeneratorFailed(Generator *generator);
 
-void GeneratorProgram(Program *program);
+void Output(Generator *generator, char *format, ...);
 
-void GeneratorStatementList(StatementList statementList);
+// Variantes sin formato, para los casos frecuentes.
+void OutputString(Generator *generator, const char *string);
 
-void GeneratorStatement(Statement *statement);
+void OutputInteger(Generator *generator, int value);
 
-void GeneratorAssignment(Assignment *assignment);
+void GeneratorProgram(Generator *generator, Program *program);
 
-void GeneratorFunctionCall(FunctionCall *functionCall);
+// Apertura y cierre del programa, para generarlo sentencia por sentencia.
+void GeneratorProgramBegin(Generator *generator);
 
-void GeneratorDeclaration(Declaration *declaration);
+void GeneratorProgramEnd(Generator *generator);
 
-void GeneratorWhileStatement(WhileStatement *whileStatement);
+// Generan una parte del programa. Ninguna es recursiva: la profundidad de
+// anidamiento del programa no afecta la pila del proceso.
+void GeneratorStatementList(Generator *generator, StatementList statementList);
 
-void GeneratorForStatement(ForStatement *forStatement);
+void GeneratorStatement(Generator *generator, Statement *statement);
 
-void GeneratorRangeExpression(RangeExpression *rangeExpression);
+void GeneratorExpression(Generator *generator, Expression *expression);
 
-void GeneratorIfStatement(IfStatement *ifStatement);
-
-void GeneratorBlock(Block *block);
-
-void GeneratorExpression(Expression *expression);
-
-void GeneratorFactor(Factor *factor);
-
-void GeneratorConstant(Constant *constant);
+void GeneratorConstant(Generator *generator, Constant *constant);
 
 #endif
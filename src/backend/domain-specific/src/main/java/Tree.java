@@ -26,6 +26,23 @@ public abstract class Tree<T extends Comparable<? super T>> implements Iterable<
     private static int DOT_FILE_COUNTER = 0;
     private static int TRAVERSAL_FILE_COUNTER = 0;
 
+    // Con -Dtla.ioReport=<archivo> (ver script/latency.sh), al terminar se
+    // escribe en ese archivo el tiempo total, en nanosegundos, escribiendo los
+    // archivos de dots/ y traversals/.
+    private static final String IO_REPORT = System.getProperty("tla.ioReport");
+    private static long IO_NANOS = 0;
+
+    static {
+        if (IO_REPORT != null) {
+            Runtime.getRuntime().addShutdownHook(new Thread(() -> {
+                try (PrintWriter writer = new PrintWriter(IO_REPORT)) {
+                    writer.println(IO_NANOS);
+                } catch (IOException ignored) {
+                }
+            }));
+        }
+    }
+
     protected Node<T> root;
     protected MutableGraph graph;
 
@@ -101,7 +118,9 @@ public abstract class Tree<T extends Comparable<? super T>> implements Iterable<
             }
         }
         String pathDot = DOT_DIR + DOT_FILE_COUNTER + DOT_EXT;
+        long start = System.nanoTime();
         Graphviz.fromGraph(graph).render(Format.DOT).toFile(new File(pathDot));
+        IO_NANOS += System.nanoTime() - start;
         DOT_FILE_COUNTER++;
     }
 
@@ -112,29 +131,35 @@ public abstract class Tree<T extends Comparable<? super T>> implements Iterable<
     }
 
     public void inorder() throws IOException {
+        long start = System.nanoTime();
         File file = new File(TRAVERSAL_DIR + "inorder" + TRAVERSAL_FILE_COUNTER + TRAVERSAL_EXT);
         PrintWriter writer = new PrintWriter(file);
 
         getInorderFromNode(root, writer);
         writer.close();
+        IO_NANOS += System.nanoTime() - start;
         TRAVERSAL_FILE_COUNTER++;
     }
 
     public void preorder() throws IOException {
+        long start = System.nanoTime();
         File file = new File(TRAVERSAL_DIR + "preorder" + TRAVERSAL_FILE_COUNTER + TRAVERSAL_EXT);
         PrintWriter writer = new PrintWriter(file);
       
         getPreorderFromNode(root, writer);  
         writer.close();
+        IO_NANOS += System.nanoTime() - start;
         TRAVERSAL_FILE_COUNTER++;
     }
 
     public void postorder() throws IOException {
+        long start = System.nanoTime();
         File file = new File(TRAVERSAL_DIR + "postorder" + TRAVERSAL_FILE_COUNTER + TRAVERSAL_EXT);
         PrintWriter writer = new PrintWriter(file);
       
         getPostorderFromNode(root, writer);
         writer.close();
+        IO_NANOS += System.nanoTime() - start;
         TRAVERSAL_FILE_COUNTER++;
     }
 
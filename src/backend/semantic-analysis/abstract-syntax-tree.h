@@ -20,9 +20,11 @@ typedef enum {
 } ConstantType;
 
 typedef struct {
-	int intValue;
-    bool boolValue;
     ConstantType type;
+    union {
+        int intValue;
+        bool boolValue;
+    };
 } Constant;
 
 /**
@@ -33,6 +35,10 @@ typedef struct {
 *
 * De este modo, al recorrer el AST, es posible determinar qué nodos hijos
 * posee según el valor de este enumerado.
+*
+* Para que el AST ocupe poco y se recorra con pocos saltos de puntero, los
+* hijos posibles de cada nodo comparten una unión, y las hojas (constantes y
+* variables) se guardan dentro del nodo "Expression" que las contiene.
 */
 
 typedef enum {
@@ -43,9 +49,11 @@ typedef enum {
 
 typedef struct {
 	FactorType type;
-	Expression * expression;
-	Constant * constant;
-	char * varname;
+	union {
+		Expression * expression;
+		Constant constant;
+		SymbolId symbol;
+	};
 } Factor;
 
 typedef enum {
@@ -68,9 +76,17 @@ typedef enum {
 
 struct Expression {
 	ExpressionType type;
-	Expression * leftExpression;
-	Expression * rightExpression;
-	Factor * factor;
+	// Tipo inferido al reducir la expresión (VAR_INVALID si está mal formada).
+	VarType dataType;
+	union {
+		// Expresiones binarias y unarias (solo "leftExpression").
+		struct {
+			Expression * leftExpression;
+			Expression * rightExpression;
+		};
+		// FACTOR_EXPRESSION.
+		Factor factor;
+	};
 };
 
 typedef struct {
@@ -95,7 +111,7 @@ typedef struct {
 } RangeExpression;
 
 typedef struct {
-	char * varname;
+	SymbolId symbol;
 	RangeExpression * range;
 	Block * block;
 } ForStatement;
@@ -135,19 +151,19 @@ typedef enum {
 
 typedef struct {
 	VarType type;
-	char * varname;
+	SymbolId symbol;
     struct Assignment * assignment;
 } Declaration;
 
 typedef struct {
 	FunctionCallType type;
-	char * varname;
+	SymbolId symbol;
 	Expression * expression;
 	Declaration * declaration;
 } FunctionCall;
 
 typedef struct Assignment {
-	char * varname;
+	SymbolId symbol;
 	Expression * expression;
     FunctionCall * functionCall;
 } Assignment;
@@ -163,19 +179,28 @@ typedef enum {
 
 typedef struct {
 	StatementType type;
-	IfStatement * ifStatement;
-	ForStatement * forStatement;
-	WhileStatement * whileStatement;
-	FunctionCall * functionCall;
-	Declaration * declaration;
-	Assignment * assignment;
+	union {
+		IfStatement * ifStatement;
+		ForStatement * forStatement;
+		WhileStatement * whileStatement;
+		FunctionCall * functionCall;
+		Declaration * declaration;
+		Assignment * assignment;
+	};
 } Statement;
 
 struct StatementNode {
-	Statement * statement;
+	Statement statement;
 	StatementList next;
 };
 
+// Lista en construcción: se conserva el último nodo para agregar al final en
+// O(1), de modo que la gramática pueda ser recursiva a izquierda.
+typedef struct {
+	StatementList first;
+	StatementList last;
+} StatementSequence;
+
 typedef struct {
 	StatementList statements;
 } Program;
@@ -0,0 +1,560 @@
+#include "ast-cache.h"
+#include "../support/mapped-file.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CACHE_MAGIC "TLA-AST"
+#define CACHE_VERSION 2
+#define CACHE_BYTE_ORDER 0x01020304u
+#define NODE_ALIGNMENT 8
+#define INITIAL_IMAGE_SIZE (64 * 1024)
+
+/*
+ * Formato del archivo, con cada sección alineada a 8 bytes:
+ *
+ *	CacheHeader
+ *	imagen: los nodos, empezando por el "Program"
+ *	relocaciones: un bit por cada palabra de 8 bytes de la imagen, encendido
+ *		si la palabra es un puntero no nulo
+ *	símbolos: un "CachedSymbol" por slot, en orden
+ *	nombres: los nombres de los símbolos, terminados en '\0'
+ *	fuente: el programa del que se obtuvo el AST
+ *
+ * Todo lo que sigue al encabezado está cubierto por "checksum", de modo que
+ * un archivo dañado se descarta en lugar de generar código inválido. El hash
+ * del fuente solo descarta rápido los que difieren; el fuente guardado se
+ * compara completo, para que una colisión no cargue el AST de otro programa.
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t layout;
+    uint32_t byteOrder;
+    uint32_t reserved;
+    uint64_t sourceHash;
+    uint64_t sourceLength;
+    uint64_t imageLength;
+    uint64_t relocationWords;
+    uint64_t symbolCount;
+    uint64_t namesLength;
+    uint64_t checksum;
+} CacheHeader;
+
+typedef struct {
+    uint64_t nameOffset;
+    uint32_t type;
+    uint32_t reserved;
+} CachedSymbol;
+
+typedef enum {
+    PROGRAM_NODE,
+    STATEMENT_NODE,
+    IF_NODE,
+    FOR_NODE,
+    WHILE_NODE,
+    FUNCTION_CALL_NODE,
+    DECLARATION_NODE,
+    ASSIGNMENT_NODE,
+    RANGE_NODE,
+    BLOCK_NODE,
+    EXPRESSION_NODE
+} NodeKind;
+
+static const size_t nodeSizes[] = {
+    [PROGRAM_NODE] = sizeof(Program),
+    [STATEMENT_NODE] = sizeof(struct StatementNode),
+    [IF_NODE] = sizeof(IfStatement),
+    [FOR_NODE] = sizeof(ForStatement),
+    [WHILE_NODE] = sizeof(WhileStatement),
+    [FUNCTION_CALL_NODE] = sizeof(FunctionCall),
+    [DECLARATION_NODE] = sizeof(Declaration),
+    [ASSIGNMENT_NODE] = sizeof(Assignment),
+    [RANGE_NODE] = sizeof(RangeExpression),
+    [BLOCK_NODE] = sizeof(Block),
+    [EXPRESSION_NODE] = sizeof(Expression)
+};
+
+// Huella de la disposición de los nodos: si cambia, la caché no sirve.
+static uint32_t Layout() {
+    uint32_t layout = sizeof(void *);
+    for (size_t i = 0; i < sizeof(nodeSizes) / sizeof(nodeSizes[0]); ++i) {
+        layout = layout * 31 + nodeSizes[i];
+    }
+    return layout;
+}
+
+// Nodo ya copiado en la imagen cuyos hijos todavía apuntan al árbol original.
+typedef struct {
+    NodeKind kind;
+    uint64_t offset;
+} Pending;
+
+typedef struct {
+    char * image;
+    uint64_t length;
+    uint64_t capacity;
+    uint64_t * relocations;
+    uint64_t relocationCapacity;
+    Pending * pending;
+    uint64_t pendingCount;
+    uint64_t pendingCapacity;
+    bool failed;
+} Serializer;
+
+static bool Reserve(void ** data, uint64_t * capacity, uint64_t needed, size_t elementSize) {
+    if (needed <= *capacity) {
+        return true;
+    }
+    uint64_t grown = *capacity == 0 ? INITIAL_IMAGE_SIZE / elementSize : *capacity;
+    while (grown < needed) {
+        grown *= 2;
+    }
+    void * reallocated = realloc(*data, grown * elementSize);
+    if (reallocated == NULL) {
+        return false;
+    }
+    *data = reallocated;
+    *capacity = grown;
+    return true;
+}
+
+#define ALIGN(length) (((length) + NODE_ALIGNMENT - 1) & ~(uint64_t) (NODE_ALIGNMENT - 1))
+
+// Copia los campos del nodo sobre "to", que está en cero. Copiar el nodo
+// entero arrastraría el relleno (y los bytes no usados de las uniones), que
+// no están inicializados: el archivo dejaría de depender solo del programa.
+static void CopyFields(void * to, const void * from, NodeKind kind) {
+    switch (kind) {
+        case PROGRAM_NODE:
+            ((Program *) to)->statements = ((const Program *) from)->statements;
+            break;
+        case STATEMENT_NODE: {
+            struct StatementNode * node = to;
+            const struct StatementNode * original = from;
+            node->statement.type = original->statement.type;
+            // Todas las alternativas de la unión son punteros.
+            node->statement.ifStatement = original->statement.ifStatement;
+            node->next = original->next;
+            break;
+        }
+        case IF_NODE: {
+            IfStatement * node = to;
+            const IfStatement * original = from;
+            node->type = original->type;
+            node->condition = original->condition;
+            node->blockIf = original->blockIf;
+            node->blockElse = original->blockElse;
+            break;
+        }
+        case FOR_NODE: {
+            ForStatement * node = to;
+            const ForStatement * original = from;
+            node->symbol = original->symbol;
+            node->range = original->range;
+            node->block = original->block;
+            break;
+        }
+        case WHILE_NODE: {
+            WhileStatement * node = to;
+            const WhileStatement * original = from;
+            node->condition = original->condition;
+            node->block = original->block;
+            break;
+        }
+        case FUNCTION_CALL_NODE: {
+            FunctionCall * node = to;
+            const FunctionCall * original = from;
+            node->type = original->type;
+            node->symbol = original->symbol;
+            node->expression = original->expression;
+            node->declaration = original->declaration;
+            break;
+        }
+        case DECLARATION_NODE: {
+            Declaration * node = to;
+            const Declaration * original = from;
+            node->type = original->type;
+            node->symbol = original->symbol;
+            node->assignment = original->assignment;
+            break;
+        }
+        case ASSIGNMENT_NODE: {
+            Assignment * node = to;
+            const Assignment * original = from;
+            node->symbol = original->symbol;
+            node->expression = original->expression;
+            node->functionCall = original->functionCall;
+            break;
+        }
+        case RANGE_NODE: {
+            RangeExpression * node = to;
+            const RangeExpression * original = from;
+            node->expressionLeft = original->expressionLeft;
+            node->expressionRight = original->expressionRight;
+            break;
+        }
+        case BLOCK_NODE:
+            ((Block *) to)->statements = ((const Block *) from)->statements;
+            break;
+        case EXPRESSION_NODE: {
+            Expression * node = to;
+            const Expression * original = from;
+            node->type = original->type;
+            node->dataType = original->dataType;
+            if (original->type != FACTOR_EXPRESSION) {
+                node->leftExpression = original->leftExpression;
+                node->rightExpression = original->rightExpression;
+                break;
+            }
+            node->factor.type = original->factor.type;
+            switch (original->factor.type) {
+                case EXPRESSION_FACTOR:
+                    node->factor.expression = original->factor.expression;
+                    break;
+                case CONSTANT_FACTOR:
+                    node->factor.constant.type = original->factor.constant.type;
+                    if (original->factor.constant.type == INT_CONSTANT) {
+                        node->factor.constant.intValue = original->factor.constant.intValue;
+                    } else {
+                        node->factor.constant.boolValue = original->factor.constant.boolValue;
+                    }
+                    break;
+                case VARIABLE_FACTOR:
+                    node->factor.symbol = original->factor.symbol;
+                    break;
+            }
+            break;
+        }
+    }
+}
+
+// Copia el nodo al final de la imagen y devuelve su posición.
+static uint64_t Copy(Serializer * serializer, const void * node, NodeKind kind) {
+    uint64_t offset = ALIGN(serializer->length);
+    uint64_t size = nodeSizes[kind];
+    if (!Reserve((void **) &serializer->image, &serializer->capacity, offset + size, 1)
+        || !Reserve((void **) &serializer->pending, &serializer->pendingCapacity, serializer->pendingCount + 1, sizeof(Pending))) {
+        serializer->failed = true;
+        return 0;
+    }
+    memset(serializer->image + serializer->length, 0, offset + size - serializer->length);
+    CopyFields(serializer->image + offset, node, kind);
+    serializer->length = offset + size;
+    serializer->pending[serializer->pendingCount++] = (Pending) {kind, offset};
+    return offset;
+}
+
+// Copia el hijo apuntado por el campo del nodo y reemplaza el puntero por su
+// posición en la imagen.
+static void Link(Serializer * serializer, uint64_t nodeOffset, size_t fieldOffset, NodeKind kind) {
+    uint64_t field = nodeOffset + fieldOffset;
+    void * child;
+    memcpy(&child, serializer->image + field, sizeof(child));
+    if (child == NULL || serializer->failed) {
+        return;
+    }
+    uint64_t childOffset = Copy(serializer, child, kind);
+    uint64_t word = field / sizeof(uint64_t);
+    uint64_t previousCapacity = serializer->relocationCapacity;
+    if (serializer->failed || !Reserve((void **) &serializer->relocations, &serializer->relocationCapacity, word / 64 + 1, sizeof(uint64_t))) {
+        serializer->failed = true;
+        return;
+    }
+    memset(serializer->relocations + previousCapacity, 0, (serializer->relocationCapacity - previousCapacity) * sizeof(uint64_t));
+    memcpy(serializer->image + field, &childOffset, sizeof(childOffset));
+    serializer->relocations[word / 64] |= (uint64_t) 1 << (word % 64);
+}
+
+static void LinkChildren(Serializer * serializer, Pending node) {
+    const void * copy = serializer->image + node.offset;
+    switch (node.kind) {
+        case PROGRAM_NODE:
+            Link(serializer, node.offset, offsetof(Program, statements), STATEMENT_NODE);
+            break;
+        case STATEMENT_NODE: {
+            static const NodeKind statementKinds[] = {
+                [IF_STATEMENT] = IF_NODE,
+                [FOR_STATEMENT] = FOR_NODE,
+                [WHILE_STATEMENT] = WHILE_NODE,
+                [FUNCTION_CALL_STATEMENT] = FUNCTION_CALL_NODE,
+                [DECLARATION_STATEMENT] = DECLARATION_NODE,
+                [ASSIGNMENT_STATEMENT] = ASSIGNMENT_NODE
+            };
+            NodeKind kind = statementKinds[((const struct StatementNode *) copy)->statement.type];
+            Link(serializer, node.offset, offsetof(struct StatementNode, next), STATEMENT_NODE);
+            Link(serializer, node.offset, offsetof(struct StatementNode, statement.ifStatement), kind);
+            break;
+        }
+        case IF_NODE:
+            Link(serializer, node.offset, offsetof(IfStatement, condition), EXPRESSION_NODE);
+            Link(serializer, node.offset, offsetof(IfStatement, blockIf), BLOCK_NODE);
+            Link(serializer, node.offset, offsetof(IfStatement, blockElse), BLOCK_NODE);
+            break;
+        case FOR_NODE:
+            Link(serializer, node.offset, offsetof(ForStatement, range), RANGE_NODE);
+            Link(serializer, node.offset, offsetof(ForStatement, block), BLOCK_NODE);
+            break;
+        case WHILE_NODE:
+            Link(serializer, node.offset, offsetof(WhileStatement, condition), EXPRESSION_NODE);
+            Link(serializer, node.offset, offsetof(WhileStatement, block), BLOCK_NODE);
+            break;
+        case FUNCTION_CALL_NODE:
+            Link(serializer, node.offset, offsetof(FunctionCall, expression), EXPRESSION_NODE);
+            Link(serializer, node.offset, offsetof(FunctionCall, declaration), DECLARATION_NODE);
+            break;
+        case DECLARATION_NODE:
+            Link(serializer, node.offset, offsetof(Declaration, assignment), ASSIGNMENT_NODE);
+            break;
+        case ASSIGNMENT_NODE:
+            Link(serializer, node.offset, offsetof(Assignment, expression), EXPRESSION_NODE);
+            Link(serializer, node.offset, offsetof(Assignment, functionCall), FUNCTION_CALL_NODE);
+            break;
+        case RANGE_NODE:
+            Link(serializer, node.offset, offsetof(RangeExpression, expressionLeft), EXPRESSION_NODE);
+            Link(serializer, node.offset, offsetof(RangeExpression, expressionRight), EXPRESSION_NODE);
+            break;
+        case BLOCK_NODE:
+            Link(serializer, node.offset, offsetof(Block, statements), STATEMENT_NODE);
+            break;
+        case EXPRESSION_NODE: {
+            const Expression * expression = copy;
+            if (expression->type != FACTOR_EXPRESSION) {
+                Link(serializer, node.offset, offsetof(Expression, leftExpression), EXPRESSION_NODE);
+                Link(serializer, node.offset, offsetof(Expression, rightExpression), EXPRESSION_NODE);
+            } else if (expression->factor.type == EXPRESSION_FACTOR) {
+                Link(serializer, node.offset, offsetof(Expression, factor.expression), EXPRESSION_NODE);
+            }
+            break;
+        }
+    }
+}
+
+uint64_t astCacheHash(const char * source, uint64_t length) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (uint64_t i = 0; i < length; ++i) {
+        hash ^= (unsigned char) source[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Suma de verificación de a palabras de 8 bytes ("length" es múltiplo de 8).
+static uint64_t Checksum(uint64_t checksum, const void * data, uint64_t length) {
+    const char * bytes = data;
+    for (uint64_t i = 0; i < length; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        checksum = (checksum ^ word) * 0x100000001b3ULL;
+        checksum ^= checksum >> 29;
+    }
+    return checksum;
+}
+
+static bool WriteAll(FILE * file, const void * data, uint64_t length) {
+    return length == 0 || fwrite(data, 1, length, file) == length;
+}
+
+static bool WriteCache(FILE * file, CacheHeader * header, Serializer * serializer, symbolTableADT symbols, const char * source) {
+    CachedSymbol * cachedSymbols = calloc(header->symbolCount + 1, sizeof(CachedSymbol));
+    char * names = calloc(header->namesLength + 1, 1);
+    // El fuente se completa con '\0' hasta múltiplo de 8.
+    const uint64_t sourcePadding = ALIGN(header->sourceLength) - header->sourceLength;
+    const char padding[NODE_ALIGNMENT] = {0};
+    bool written = cachedSymbols != NULL && names != NULL;
+    uint64_t nameOffset = 0;
+    for (uint64_t i = 0; written && i < header->symbolCount; ++i) {
+        Symbol * symbol = symbolTableGet(symbols, i);
+        size_t length = strlen(symbol->varname) + 1;
+        cachedSymbols[i] = (CachedSymbol) {.nameOffset = nameOffset, .type = symbol->type};
+        memcpy(names + nameOffset, symbol->varname, length);
+        nameOffset += length;
+    }
+    if (written) {
+        uint64_t checksum = Checksum(0, serializer->image, header->imageLength);
+        checksum = Checksum(checksum, serializer->relocations, header->relocationWords * sizeof(uint64_t));
+        checksum = Checksum(checksum, cachedSymbols, header->symbolCount * sizeof(CachedSymbol));
+        checksum = Checksum(checksum, names, header->namesLength);
+        if (sourcePadding == 0) {
+            checksum = Checksum(checksum, source, header->sourceLength);
+        } else {
+            // La última palabra incompleta se arma con el relleno.
+            const uint64_t whole = header->sourceLength - (NODE_ALIGNMENT - sourcePadding);
+            char last[NODE_ALIGNMENT] = {0};
+            memcpy(last, source + whole, NODE_ALIGNMENT - sourcePadding);
+            checksum = Checksum(checksum, source, whole);
+            checksum = Checksum(checksum, last, NODE_ALIGNMENT);
+        }
+        header->checksum = checksum;
+        written = WriteAll(file, header, sizeof(CacheHeader))
+            && WriteAll(file, serializer->image, header->imageLength)
+            && WriteAll(file, serializer->relocations, header->relocationWords * sizeof(uint64_t))
+            && WriteAll(file, cachedSymbols, header->symbolCount * sizeof(CachedSymbol))
+            && WriteAll(file, names, header->namesLength)
+            && WriteAll(file, source, header->sourceLength)
+            && WriteAll(file, padding, sourcePadding);
+    }
+    free(cachedSymbols);
+    free(names);
+    return written;
+}
+
+bool astCacheStore(const char * path, uint64_t sourceHash, const char * source, uint64_t sourceLength, Program * program, symbolTableADT symbols) {
+    Serializer serializer = {0};
+    Copy(&serializer, program, PROGRAM_NODE);
+    while (!serializer.failed && serializer.pendingCount > 0) {
+        LinkChildren(&serializer, serializer.pending[--serializer.pendingCount]);
+    }
+
+    CacheHeader header = {
+        .magic = CACHE_MAGIC,
+        .version = CACHE_VERSION,
+        .layout = Layout(),
+        .byteOrder = CACHE_BYTE_ORDER,
+        .sourceHash = sourceHash,
+        .sourceLength = sourceLength,
+        // Las relocaciones quedan alineadas si la imagen también lo está.
+        .imageLength = ALIGN(serializer.length),
+        .symbolCount = symbolTableSize(symbols)
+    };
+    header.relocationWords = (header.imageLength / sizeof(uint64_t) + 63) / 64;
+    for (uint64_t i = 0; i < header.symbolCount; ++i) {
+        header.namesLength += strlen(symbolTableGet(symbols, i)->varname) + 1;
+    }
+    // Se completa con '\0' hasta múltiplo de 8, como el resto de las secciones.
+    header.namesLength = ALIGN(header.namesLength);
+
+    // Se escribe en un temporal y se renombra, para que un lector nunca vea
+    // un archivo a medio escribir.
+    char * temporaryPath = malloc(strlen(path) + sizeof(".XXXXXX"));
+    bool stored = false;
+    uint64_t relocationCapacity = serializer.relocationCapacity;
+    if (!serializer.failed && temporaryPath != NULL
+        && Reserve((void **) &serializer.image, &serializer.capacity, header.imageLength, 1)
+        && Reserve((void **) &serializer.relocations, &serializer.relocationCapacity, header.relocationWords, sizeof(uint64_t))) {
+        memset(serializer.image + serializer.length, 0, header.imageLength - serializer.length);
+        memset(serializer.relocations + relocationCapacity, 0, (serializer.relocationCapacity - relocationCapacity) * sizeof(uint64_t));
+        sprintf(temporaryPath, "%s.XXXXXX", path);
+        int fd = mkstemp(temporaryPath);
+        FILE * file = fd < 0 ? NULL : fdopen(fd, "wb");
+        if (file == NULL && fd >= 0) {
+            close(fd);
+        }
+        if (file != NULL) {
+            stored = WriteCache(file, &header, &serializer, symbols, source);
+            stored = fclose(file) == 0 && stored;
+            stored = stored && rename(temporaryPath, path) == 0;
+            if (!stored) {
+                unlink(temporaryPath);
+            }
+        }
+    }
+    free(temporaryPath);
+    free(serializer.image);
+    free(serializer.relocations);
+    free(serializer.pending);
+    return stored;
+}
+
+typedef struct astCacheCDT {
+    mappedFileADT file;
+    Program * program;
+} astCacheCDT;
+
+// Verifica que cada sección entre en el archivo, sin desbordar.
+static bool Fits(uint64_t * offset, uint64_t count, uint64_t elementSize, uint64_t fileSize) {
+    if (count > (fileSize - *offset) / elementSize) {
+        return false;
+    }
+    *offset += count * elementSize;
+    return true;
+}
+
+astCacheADT astCacheLoad(const char * path, uint64_t sourceHash, const char * source, uint64_t sourceLength, symbolTableADT symbols) {
+    mappedFileADT file = mappedFileOpen(path);
+    if (file == NULL) {
+        return NULL;
+    }
+    char * data = mappedFileData(file);
+    uint64_t size = mappedFileSize(file);
+    CacheHeader header;
+    if (size < sizeof(CacheHeader)) {
+        mappedFileClose(file);
+        return NULL;
+    }
+    memcpy(&header, data, sizeof(CacheHeader));
+    uint64_t end = sizeof(CacheHeader);
+    if (memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != CACHE_VERSION
+        || header.layout != Layout() || header.byteOrder != CACHE_BYTE_ORDER
+        || header.sourceHash != sourceHash || header.sourceLength != sourceLength
+        || header.imageLength % NODE_ALIGNMENT != 0 || header.imageLength < sizeof(Program)
+        || !Fits(&end, header.imageLength, 1, size) || header.relocationWords != (header.imageLength / sizeof(uint64_t) + 63) / 64
+        || !Fits(&end, header.relocationWords, sizeof(uint64_t), size)
+        || !Fits(&end, header.symbolCount, sizeof(CachedSymbol), size) || !Fits(&end, header.namesLength, 1, size)
+        || !Fits(&end, ALIGN(sourceLength), 1, size)
+        || end != size || header.symbolCount > INT32_MAX || header.namesLength % NODE_ALIGNMENT != 0
+        || (header.namesLength > 0 && data[size - ALIGN(sourceLength) - 1] != '\0')
+        || memcmp(data + size - ALIGN(sourceLength), source, sourceLength) != 0
+        || Checksum(0, data + sizeof(CacheHeader), size - sizeof(CacheHeader)) != header.checksum) {
+        mappedFileClose(file);
+        return NULL;
+    }
+    char * image = data + sizeof(CacheHeader);
+    const uint64_t * relocations = (const uint64_t *) (image + header.imageLength);
+    const CachedSymbol * cachedSymbols = (const CachedSymbol *) (relocations + header.relocationWords);
+    char * names = (char *) (cachedSymbols + header.symbolCount);
+
+    // Un puntero fuera de la imagen indica un archivo dañado.
+    uint64_t * words = (uint64_t *) image;
+    uint64_t wordCount = header.imageLength / sizeof(uint64_t);
+    for (uint64_t i = 0; i < header.relocationWords; ++i) {
+        for (uint64_t bits = relocations[i]; bits != 0; bits &= bits - 1) {
+            uint64_t word = i * 64 + __builtin_ctzll(bits);
+            if (word >= wordCount || words[word] >= header.imageLength) {
+                mappedFileClose(file);
+                return NULL;
+            }
+            words[word] += (uintptr_t) image;
+        }
+    }
+    for (uint64_t i = 0; i < header.symbolCount; ++i) {
+        if (cachedSymbols[i].nameOffset >= header.namesLength) {
+            mappedFileClose(file);
+            return NULL;
+        }
+    }
+
+    astCacheADT cache = malloc(sizeof(astCacheCDT));
+    if (cache == NULL) {
+        mappedFileClose(file);
+        return NULL;
+    }
+    // Los nombres restaurados apuntan al archivo: si falla a mitad de camino,
+    // se descartan antes de desmapearlo.
+    const SymbolTableMark restored = symbolTableMark(symbols);
+    for (uint64_t i = 0; i < header.symbolCount; ++i) {
+        if (symbolTableRestore(symbols, names + cachedSymbols[i].nameOffset, cachedSymbols[i].type) == NO_SYMBOL) {
+            symbolTableRollback(symbols, restored);
+            free(cache);
+            mappedFileClose(file);
+            return NULL;
+        }
+    }
+    cache->file = file;
+    cache->program = (Program *) image;
+    return cache;
+}
+
+Program * astCacheProgram(astCacheADT cache) {
+    return cache->program;
+}
+
+void astCacheClose(astCacheADT cache) {
+    if (cache == NULL) {
+        return;
+    }
+    mappedFileClose(cache->file);
+    free(cache);
+}
@@ -0,0 +1,40 @@
+#ifndef AST_CACHE_H
+#define AST_CACHE_H
+
+#include "abstract-syntax-tree.h"
+#include "symbol-table.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Caché del AST ya validado, para no volver a analizar un fuente que no
+ * cambió. El archivo guarda todos los nodos del programa contiguos, con los
+ * punteros reemplazados por desplazamientos desde el primer nodo, y la lista
+ * de posiciones donde hay un puntero. Cargarlo es mapearlo y sumar la
+ * dirección base en esas posiciones; los nodos no se copian.
+ *
+ * El formato depende del tamaño de los nodos, que se verifica al cargar: un
+ * archivo de otra versión del compilador simplemente no se usa.
+ */
+
+typedef struct astCacheCDT * astCacheADT;
+
+// Clave del fuente (FNV-1a de 64 bits sobre su contenido). Sirve para nombrar
+// el archivo; dos fuentes con la misma clave no se confunden, porque el
+// archivo guarda el fuente completo y se compara al cargar.
+uint64_t astCacheHash(const char * source, uint64_t length);
+
+// Guarda el programa, sus símbolos y el fuente del que se obtuvo en "path",
+// reemplazándolo de forma atómica. Devuelve false si no se pudo escribir.
+bool astCacheStore(const char * path, uint64_t sourceHash, const char * source, uint64_t sourceLength, Program * program, symbolTableADT symbols);
+
+// Carga el programa guardado en "path" y restaura sus símbolos en "symbols",
+// que debe estar vacía. Devuelve NULL si no hay caché para ese fuente.
+astCacheADT astCacheLoad(const char * path, uint64_t sourceHash, const char * source, uint64_t sourceLength, symbolTableADT symbols);
+
+// El programa (y los nombres de sus símbolos) viven hasta "astCacheClose".
+Program * astCacheProgram(astCacheADT cache);
+
+void astCacheClose(astCacheADT cache);
+
+#endif
@@ -6,22 +6,265 @@
 #include <stdbool.h>
 #include <string.h>
 
+/**
+ * Hash map de direccionamiento abierto, generado por macros para cada par de
+ * tipos clave/valor. Las claves y los valores se guardan dentro de la tabla
+ * (sin un malloc por entrada), el tamaño es siempre potencia de 2 (se usa una
+ * máscara en lugar de "%"), la inserción es Robin Hood y el borrado desplaza
+ * hacia atrás las entradas siguientes, por lo que nunca quedan tombstones.
+ *
+ * Uso:
+ *	HASHMAP_DECLARE(name, keyType, valueType)
+ *		Declara los tipos "nameEntry", "nameADT" y los prototipos.
+ *	HASHMAP_DEFINE(name, keyType, valueType, hashFunction, keyEquals)
+ *		Define las funciones, donde:
+ *			uint64_t hashFunction(const keyType * key);
+ *			bool keyEquals(const keyType * key1, const keyType * key2);
+ *
+ * Funciones generadas:
+ *	nameADT nameInit(uint64_t initialSize);
+ *	valueType * nameGet(nameADT hm, const keyType * key);
+ *	bool nameFind(nameADT hm, const keyType * key, valueType * value);
+ *	bool nameInsertOrUpdate(nameADT hm, const keyType * key, valueType value);
+ *		Devuelve false si la clave era nueva y no hubo memoria para agrandar
+ *		la tabla: en ese caso no se inserta. Actualizar nunca falla.
+ *	bool nameRemove(nameADT hm, const keyType * key);
+ *	uint64_t nameSize(nameADT hm);
+ *	void nameStats(nameADT hm, HashMapStats * stats);
+ *	void nameDestroy(nameADT hm);
+ */
 
-typedef void * tAny;
-typedef uint64_t (*hashFp)(tAny);
-typedef bool (*keyEqualsFp)(tAny, tAny);
-typedef struct hashMapCDT * hashMapADT;
+#define HASHMAP_INITIAL_SIZE 16
 
-hashMapADT hashMapInit(uint64_t keySize, uint64_t valueSize, hashFp prehash, keyEqualsFp keyEquals);
+// El hash 0 se reserva para marcar las entradas libres.
+#define HASHMAP_FREE 0
 
-void hashMapInsertOrUpdate(hashMapADT hm, tAny key, tAny value);
+// Factor de carga máximo: 3/4 de la tabla.
+#define HASHMAP_THRESHOLD(size) ((size) - ((size) >> 2))
 
-bool hashMapRemove(hashMapADT hm, tAny key);
+// El histograma de sondeos distingue distancias 0..HASHMAP_PROBE_BUCKETS-2;
+// la última posición cuenta las mayores.
+#define HASHMAP_PROBE_BUCKETS 8
 
-bool hashMapFind(hashMapADT hm, tAny key, tAny value);
+typedef struct {
+    uint64_t capacity;
+    uint64_t size;
+    uint64_t resizes;
+    // No hay tombstones: cada borrado desplaza hacia atrás las entradas que
+    // le siguen ("shifted" las suma).
+    uint64_t removals;
+    uint64_t shifted;
+    // Entradas según su distancia a la posición ideal, que son los sondeos
+    // extra de una búsqueda exitosa.
+    uint64_t probes[HASHMAP_PROBE_BUCKETS];
+    uint64_t maxProbe;
+} HashMapStats;
 
-uint64_t hashMapsize(hashMapADT hm);
+// Mezcla final de MurmurHash3, para que los bits bajos (los que usa la
+// máscara) dependan de todo el hash.
+static inline uint64_t hashMapMix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h == HASHMAP_FREE ? 1 : h;
+}
 
-void hashMapDestroy(hashMapADT hm);
+static inline uint64_t hashMapRoundSize(uint64_t size) {
+    uint64_t rounded = HASHMAP_INITIAL_SIZE;
+    while (rounded < size) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+#define HASHMAP_DECLARE(name, keyType, valueType)                                                       \
+    typedef struct {                                                                                    \
+        uint64_t hash;                                                                                  \
+        keyType key;                                                                                    \
+        valueType value;                                                                                \
+    } name##Entry;                                                                                      \
+                                                                                                        \
+    typedef struct name##CDT {                                                                          \
+        name##Entry * lookup;                                                                           \
+        uint64_t mask;                                                                                  \
+        uint64_t usedSize;                                                                              \
+        /* Contadores para "name##Stats". */                                                            \
+        uint64_t resizes;                                                                               \
+        uint64_t removals;                                                                              \
+        uint64_t shifted;                                                                               \
+    } name##CDT;                                                                                        \
+                                                                                                        \
+    typedef name##CDT * name##ADT;                                                                      \
+                                                                                                        \
+    name##ADT name##Init(uint64_t initialSize);                                                         \
+    valueType * name##Get(name##ADT hm, const keyType * key);                                           \
+    bool name##Find(name##ADT hm, const keyType * key, valueType * value);                              \
+    bool name##InsertOrUpdate(name##ADT hm, const keyType * key, valueType value);                      \
+    bool name##Remove(name##ADT hm, const keyType * key);                                               \
+    uint64_t name##Size(name##ADT hm);                                                                  \
+    void name##Stats(name##ADT hm, HashMapStats * stats);                                               \
+    void name##Destroy(name##ADT hm);
+
+#define HASHMAP_DEFINE(name, keyType, valueType, hashFunction, keyEquals)                               \
+    /* Distancia de la entrada en "index" a su posición ideal. */                                       \
+    static inline uint64_t name##Distance(name##ADT hm, uint64_t hash, uint64_t index) {                \
+        return (index - (hash & hm->mask)) & hm->mask;                                                  \
+    }                                                                                                   \
+                                                                                                        \
+    /* Ubica una entrada que se sabe ausente, desplazando a las más cercanas a su posición ideal. */   \
+    static void name##Place(name##ADT hm, name##Entry entry) {                                          \
+        uint64_t index = entry.hash & hm->mask;                                                         \
+        uint64_t distance = 0;                                                                          \
+        while (hm->lookup[index].hash != HASHMAP_FREE) {                                                \
+            uint64_t current = name##Distance(hm, hm->lookup[index].hash, index);                       \
+            if (current < distance) {                                                                   \
+                name##Entry aux = hm->lookup[index];                                                    \
+                hm->lookup[index] = entry;                                                              \
+                entry = aux;                                                                            \
+                distance = current;                                                                     \
+            }                                                                                           \
+            index = (index + 1) & hm->mask;                                                             \
+            distance++;                                                                                 \
+        }                                                                                               \
+        hm->lookup[index] = entry;                                                                      \
+    }                                                                                                   \
+                                                                                                        \
+    static bool name##Resize(name##ADT hm) {                                                            \
+        name##Entry * oldTable = hm->lookup;                                                            \
+        uint64_t oldSize = hm->mask + 1;                                                                \
+        name##Entry * newTable = calloc(oldSize * 2, sizeof(name##Entry));                              \
+        if (newTable == NULL) {                                                                         \
+            return false;                                                                               \
+        }                                                                                               \
+        hm->lookup = newTable;                                                                          \
+        hm->mask = oldSize * 2 - 1;                                                                     \
+        for (uint64_t i = 0; i < oldSize; i++) {                                                        \
+            if (oldTable[i].hash != HASHMAP_FREE) {                                                     \
+                name##Place(hm, oldTable[i]);                                                           \
+            }                                                                                           \
+        }                                                                                               \
+        free(oldTable);                                                                                 \
+        hm->resizes++;                                                                                  \
+        return true;                                                                                    \
+    }                                                                                                   \
+                                                                                                        \
+    /* Índice de la entrada con esa clave, o -1 si no está. */                                          \
+    static int64_t name##Index(name##ADT hm, const keyType * key) {                                     \
+        uint64_t hash = hashMapMix(hashFunction(key));                                                  \
+        uint64_t index = hash & hm->mask;                                                               \
+        for (uint64_t distance = 0;; distance++) {                                                      \
+            name##Entry * aux = &hm->lookup[index];                                                     \
+            if (aux->hash == HASHMAP_FREE || name##Distance(hm, aux->hash, index) < distance) {         \
+                return -1;                                                                              \
+            }                                                                                           \
+            if (aux->hash == hash && keyEquals(&aux->key, key)) {                                       \
+                return index;                                                                           \
+            }                                                                                           \
+            index = (index + 1) & hm->mask;                                                             \
+        }                                                                                               \
+    }                                                                                                   \
+                                                                                                        \
+    name##ADT name##Init(uint64_t initialSize) {                                                        \
+        name##ADT new = calloc(1, sizeof(name##CDT));                                                   \
+        uint64_t size = hashMapRoundSize(initialSize);                                                  \
+        if (new == NULL || (new->lookup = calloc(size, sizeof(name##Entry))) == NULL) {                 \
+            free(new);                                                                                  \
+            return NULL;                                                                                \
+        }                                                                                               \
+        new->mask = size - 1;                                                                           \
+        new->usedSize = 0;                                                                              \
+        return new;                                                                                     \
+    }                                                                                                   \
+                                                                                                        \
+    valueType * name##Get(name##ADT hm, const keyType * key) {                                          \
+        int64_t index = name##Index(hm, key);                                                           \
+        return index < 0 ? NULL : &hm->lookup[index].value;                                             \
+    }                                                                                                   \
+                                                                                                        \
+    bool name##Find(name##ADT hm, const keyType * key, valueType * value) {                             \
+        valueType * found = name##Get(hm, key);                                                         \
+        if (found == NULL) {                                                                            \
+            return false;                                                                               \
+        }                                                                                               \
+        if (value != NULL) {                                                                            \
+            *value = *found;                                                                            \
+        }                                                                                               \
+        return true;                                                                                    \
+    }                                                                                                   \
+                                                                                                        \
+    bool name##InsertOrUpdate(name##ADT hm, const keyType * key, valueType value) {                     \
+        uint64_t hash = hashMapMix(hashFunction(key));                                                  \
+        uint64_t index = hash & hm->mask;                                                               \
+        for (uint64_t distance = 0;; distance++) {                                                      \
+            name##Entry * aux = &hm->lookup[index];                                                     \
+            if (aux->hash == HASHMAP_FREE || name##Distance(hm, aux->hash, index) < distance) {         \
+                break;                                                                                  \
+            }                                                                                           \
+            if (aux->hash == hash && keyEquals(&aux->key, key)) {                                       \
+                aux->value = value;                                                                     \
+                return true;                                                                            \
+            }                                                                                           \
+            index = (index + 1) & hm->mask;                                                             \
+        }                                                                                               \
+        if (hm->usedSize + 1 > HASHMAP_THRESHOLD(hm->mask + 1) && !name##Resize(hm)) {                  \
+            return false;                                                                               \
+        }                                                                                               \
+        name##Entry entry = {.hash = hash, .key = *key, .value = value};                                \
+        name##Place(hm, entry);                                                                         \
+        hm->usedSize++;                                                                                 \
+        return true;                                                                                    \
+    }                                                                                                   \
+                                                                                                        \
+    bool name##Remove(name##ADT hm, const keyType * key) {                                              \
+        int64_t found = name##Index(hm, key);                                                           \
+        if (found < 0) {                                                                                \
+            return false;                                                                               \
+        }                                                                                               \
+        uint64_t index = found;                                                                         \
+        uint64_t next = (index + 1) & hm->mask;                                                         \
+        while (hm->lookup[next].hash != HASHMAP_FREE                                                    \
+                && name##Distance(hm, hm->lookup[next].hash, next) > 0) {                               \
+            hm->lookup[index] = hm->lookup[next];                                                       \
+            hm->shifted++;                                                                              \
+            index = next;                                                                               \
+            next = (next + 1) & hm->mask;                                                               \
+        }                                                                                               \
+        hm->lookup[index].hash = HASHMAP_FREE;                                                          \
+        hm->usedSize--;                                                                                 \
+        hm->removals++;                                                                                 \
+        return true;                                                                                    \
+    }                                                                                                   \
+                                                                                                        \
+    uint64_t name##Size(name##ADT hm) {                                                                 \
+        return hm->usedSize;                                                                            \
+    }                                                                                                   \
+                                                                                                        \
+    void name##Stats(name##ADT hm, HashMapStats * stats) {                                              \
+        *stats = (HashMapStats) {                                                                       \
+            .capacity = hm->mask + 1,                                                                   \
+            .size = hm->usedSize,                                                                       \
+            .resizes = hm->resizes,                                                                     \
+            .removals = hm->removals,                                                                   \
+            .shifted = hm->shifted                                                                      \
+        };                                                                                              \
+        for (uint64_t i = 0; i <= hm->mask; i++) {                                                      \
+            if (hm->lookup[i].hash == HASHMAP_FREE) {                                                   \
+                continue;                                                                               \
+            }                                                                                           \
+            uint64_t distance = name##Distance(hm, hm->lookup[i].hash, i);                              \
+            stats->probes[distance < HASHMAP_PROBE_BUCKETS ? distance : HASHMAP_PROBE_BUCKETS - 1]++;   \
+            if (distance > stats->maxProbe) {                                                           \
+                stats->maxProbe = distance;                                                             \
+            }                                                                                           \
+        }                                                                                               \
+    }                                                                                                   \
+                                                                                                        \
+    void name##Destroy(name##ADT hm) {                                                                  \
+        if (hm == NULL) {                                                                               \
+            return;                                                                                     \
+        }                                                                                               \
+        free(hm->lookup);                                                                               \
+        free(hm);                                                                                       \
+    }
 
 #endif
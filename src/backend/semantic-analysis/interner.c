@@ -0,0 +1,106 @@
+#include "interner.h"
+#include "hashmap.h"
+#include "../support/arena.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SEED 0x13572468
+#define INTERNER_ARENA_BLOCK_SIZE (16 * 1024)
+
+// El hash se guarda justo antes del texto, así se recupera desde el puntero.
+typedef struct {
+    uint64_t hash;
+    char name[];
+} internedString;
+
+struct lexeme {
+    const char * text;
+    int length;
+};
+
+// MurmurOAAT_32_Modified
+static inline uint64_t lexemeHashFunction(const struct lexeme * lexeme) {
+
+    uint64_t h = SEED;
+
+    // One-byte-at-a-time hash based on Murmur's mix
+    // Source: https://github.com/aappleby/smhasher/blob/master/src/Hashes.cpp
+    for (int i = 0; i < lexeme->length; ++i) {
+        h ^= lexeme->text[i];
+        h *= 0x5bd1e995;
+        h ^= h >> 15;
+    }
+    return h;
+}
+
+static inline bool lexemeEquals(const struct lexeme * lexeme1, const struct lexeme * lexeme2) {
+    return lexeme1->length == lexeme2->length && memcmp(lexeme1->text, lexeme2->text, lexeme1->length) == 0;
+}
+
+// Nombre ya guardado en la arena: es el valor del mapa.
+typedef char * InternedName;
+
+HASHMAP_DECLARE(internMap, struct lexeme, InternedName)
+HASHMAP_DEFINE(internMap, struct lexeme, InternedName, lexemeHashFunction, lexemeEquals)
+
+typedef struct internerCDT {
+    internMapADT table;
+    arenaADT strings;
+} internerCDT;
+
+internerADT internerInit() {
+    internerADT new = malloc(sizeof(internerCDT));
+    if (new == NULL) {
+        return NULL;
+    }
+    new->table = internMapInit(HASHMAP_INITIAL_SIZE);
+    new->strings = arenaInit(INTERNER_ARENA_BLOCK_SIZE);
+    if (new->table == NULL || new->strings == NULL) {
+        internerDestroy(new);
+        return NULL;
+    }
+    return new;
+}
+
+char * internString(internerADT interner, const char * lexeme, int length) {
+    struct lexeme key = {.text = lexeme, .length = length};
+    InternedName * found = internMapGet(interner->table, &key);
+    if (found != NULL) {
+        return *found;
+    }
+
+    internedString * new = arenaAlloc(interner->strings, sizeof(internedString) + length + 1);
+    if (new == NULL) {
+        return NULL;
+    }
+    new->hash = lexemeHashFunction(&key);
+    memcpy(new->name, lexeme, length);
+    new->name[length] = '\0';
+
+    key.text = new->name;
+    InternedName name = new->name;
+    if (!internMapInsertOrUpdate(interner->table, &key, name)) {
+        return NULL;
+    }
+    return name;
+}
+
+uint64_t internedHash(const char * interned) {
+    return ((const internedString *) (interned - offsetof(internedString, name)))->hash;
+}
+
+void internerStats(internerADT interner, HashMapStats * table, ArenaStats * strings) {
+    internMapStats(interner->table, table);
+    arenaStats(interner->strings, strings);
+}
+
+void internerDestroy(internerADT interner) {
+    if (interner == NULL) {
+        return;
+    }
+    internMapDestroy(interner->table);
+    arenaDestroy(interner->strings);
+    free(interner);
+}
@@ -0,0 +1,30 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include "hashmap.h"
+#include "../support/arena.h"
+#include <stdint.h>
+
+/**
+ * Tabla de identificadores de una compilación. Cada nombre distinto se
+ * almacena una sola vez junto con su hash, por lo que dos identificadores son
+ * iguales si y solo si sus punteros lo son.
+ */
+
+typedef struct internerCDT * internerADT;
+
+internerADT internerInit();
+
+// Devuelve la copia canónica del lexema, que no necesita terminar en '\0', o
+// NULL si no hay memoria.
+char * internString(internerADT interner, const char * lexeme, int length);
+
+// Hash precalculado de un string devuelto por "internString".
+uint64_t internedHash(const char * interned);
+
+// Tabla de nombres y arena donde se guardan sus textos.
+void internerStats(internerADT interner, HashMapStats * table, ArenaStats * strings);
+
+void internerDestroy(internerADT interner);
+
+#endif
@@ -1,51 +1,221 @@
 #include "symbol-table.h"
 #include "hashmap.h"
 #include <stdint.h>
-#include <string.h>
+#include <stdlib.h>
 
-#define SEED 0x13572468
+#define INITIAL_LOG_SIZE 16
 
-static hashMapADT table = NULL;
+HASHMAP_DECLARE(symbolMap, struct key, SymbolId)
+HASHMAP_DEFINE(symbolMap, struct key, SymbolId, symbolHashFunction, symbolKeyEquals)
 
-// MurmurOAAT_32_Modified
-static uint64_t symbolHashFunction(tAny key) {
+/**
+ * Todos los scopes comparten una única tabla, que siempre contiene el slot
+ * visible para cada nombre. Cada declaración se registra en un log de
+ * deshacer junto con el slot que ocultó (si había uno); cerrar un scope es
+ * recorrer el log hasta la marca que dejó su apertura.
+ */
+struct shadowed {
+    struct key key;
+    SymbolId previous;
+};
 
-    uint64_t h = SEED;
-    struct key aux = *(struct key*) key;
+// Metadata de un símbolo antes de que "symbolTableModify" la entregara.
+struct change {
+    SymbolId symbol;
+    struct metadata previous;
+};
 
-    const char * str = aux.varname;
-    // One-byte-at-a-time hash based on Murmur's mix
-    // Source: https://github.com/aappleby/smhasher/blob/master/src/Hashes.cpp
-    for (; *str; ++str) {
-        h ^= *str;
-        h *= 0x5bd1e995;
-        h ^= h >> 15;
+typedef struct symbolTableCDT {
+    symbolMapADT visible;
+
+    Symbol * symbols;
+    uint32_t symbolCount;
+    uint64_t symbolsSize;
+
+    struct shadowed * undoLog;
+    uint64_t undoLogCount;
+    uint64_t undoLogSize;
+
+    uint64_t * scopeMarks;
+    uint64_t scopeCount;
+    uint64_t scopeMarksSize;
+
+    bool trackChanges;
+    struct change * changes;
+    uint64_t changeCount;
+    uint64_t changesSize;
+} symbolTableCDT;
+
+// Garantiza lugar para un elemento más en "*array", duplicando su capacidad.
+// Si no hay memoria, el arreglo queda como estaba y devuelve false.
+static bool grow(void ** array, uint64_t count, uint64_t * size, size_t elementSize) {
+    if(count < *size) {
+        return true;
+    }
+    uint64_t newSize = *size == 0 ? INITIAL_LOG_SIZE : *size * 2;
+    void * grown = realloc(*array, newSize * elementSize);
+    if(grown == NULL) {
+        return false;
     }
-    return h;
+    *array = grown;
+    *size = newSize;
+    return true;
 }
 
-static bool symbolKeyEquals(tAny key1, tAny key2) {
-    struct key aux1 = *(struct key *) key1;
-    struct key aux2 = *(struct key *) key2;
-    return strcmp(aux1.varname, aux2.varname) == 0;
+static SymbolId newSymbol(symbolTableADT table, char * varname) {
+    if(!grow((void **) &table->symbols, table->symbolCount, &table->symbolsSize, sizeof(Symbol))) {
+        return NO_SYMBOL;
+    }
+    table->symbols[table->symbolCount] = (Symbol) {.varname = varname, .type = VAR_INVALID};
+    return table->symbolCount++;
 }
 
-void symbolTableInit() {
-    if(table != NULL) {
-        symbolTableDestroy();
+symbolTableADT symbolTableInit() {
+    symbolTableADT new = calloc(1, sizeof(symbolTableCDT));
+    if(new == NULL) {
+        return NULL;
+    }
+    new->visible = symbolMapInit(HASHMAP_INITIAL_SIZE);
+    if(new->visible == NULL || !symbolTableEnterScope(new)) {
+        symbolTableDestroy(new);
+        return NULL;
     }
-    table = hashMapInit(sizeof(struct key), sizeof(struct value), symbolHashFunction, symbolKeyEquals);
+    return new;
+}
+
+SymbolId symbolTableLookup(symbolTableADT table, char * varname) {
+    struct key key = {.varname = varname};
+    SymbolId * found = symbolMapGet(table->visible, &key);
+    return found == NULL ? NO_SYMBOL : *found;
 }
 
-bool symbolTableFind(struct key * key, struct value * value) {
-    return hashMapFind(table, key, value);
+SymbolId symbolTableDeclare(symbolTableADT table, char * varname, VarType type, bool hasValue) {
+    struct key key = {.varname = varname};
+
+    if(!grow((void **) &table->undoLog, table->undoLogCount, &table->undoLogSize, sizeof(struct shadowed))) {
+        return NO_SYMBOL;
+    }
+    SymbolId symbol = newSymbol(table, varname);
+    if(symbol == NO_SYMBOL) {
+        return NO_SYMBOL;
+    }
+    Symbol * declared = &table->symbols[symbol];
+    declared->type = type;
+    declared->metadata.hasValue = hasValue;
+    declared->metadata.readOnly = false;
+
+    struct shadowed * entry = &table->undoLog[table->undoLogCount++];
+    entry->key = key;
+    entry->previous = symbolTableLookup(table, varname);
+    if(!symbolMapInsertOrUpdate(table->visible, &key, symbol)) {
+        // Se liberan el registro y el slot: nadie llegó a verlos.
+        table->undoLogCount--;
+        table->symbolCount--;
+        return NO_SYMBOL;
+    }
+    return symbol;
+}
+
+SymbolId symbolTableRestore(symbolTableADT table, char * varname, VarType type) {
+    SymbolId symbol = newSymbol(table, varname);
+    if(symbol == NO_SYMBOL) {
+        return NO_SYMBOL;
+    }
+    table->symbols[symbol].type = type;
+    return symbol;
+}
+
+Symbol * symbolTableGet(symbolTableADT table, SymbolId symbol) {
+    return &table->symbols[symbol];
+}
+
+Symbol * symbolTableModify(symbolTableADT table, SymbolId symbol) {
+    if(table->trackChanges) {
+        if(!grow((void **) &table->changes, table->changeCount, &table->changesSize, sizeof(struct change))) {
+            return NULL;
+        }
+        table->changes[table->changeCount++] = (struct change) {.symbol = symbol, .previous = table->symbols[symbol].metadata};
+    }
+    return &table->symbols[symbol];
 }
 
-void symbolTableInsert(struct key * key, struct value * value) {
-    hashMapInsertOrUpdate(table, key, value);
+uint32_t symbolTableSize(symbolTableADT table) {
+    return table->symbolCount;
 }
 
-void symbolTableDestroy() {
-    hashMapDestroy(table);
-    table = NULL;
+void symbolTableStats(symbolTableADT table, SymbolTableStats * stats) {
+    stats->symbols = table->symbolCount;
+    stats->undoLogEntries = table->undoLogCount;
+    symbolMapStats(table->visible, &stats->visible);
+}
+
+SymbolTableMark symbolTableMark(symbolTableADT table) {
+    return (SymbolTableMark) {
+        .symbols = table->symbolCount,
+        .undoLogCount = table->undoLogCount,
+        .scopeCount = table->scopeCount,
+        .changeCount = table->changeCount
+    };
+}
+
+// Vuelve a hacer visibles los símbolos que ocultaban las declaraciones
+// registradas desde "mark" en adelante.
+static bool undo(symbolTableADT table, uint64_t mark) {
+    while(table->undoLogCount > mark) {
+        struct shadowed * entry = &table->undoLog[--table->undoLogCount];
+        if(entry->previous == NO_SYMBOL) {
+            symbolMapRemove(table->visible, &entry->key);
+        } else if(!symbolMapInsertOrUpdate(table->visible, &entry->key, entry->previous)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool symbolTableRollback(symbolTableADT table, SymbolTableMark mark) {
+    while(table->changeCount > mark.changeCount) {
+        struct change * entry = &table->changes[--table->changeCount];
+        table->symbols[entry->symbol].metadata = entry->previous;
+    }
+    if(!undo(table, mark.undoLogCount)) {
+        return false;
+    }
+    if(mark.scopeCount < table->scopeCount) {
+        table->scopeCount = mark.scopeCount;
+    }
+    if(mark.symbols < table->symbolCount) {
+        table->symbolCount = mark.symbols;
+    }
+    return true;
+}
+
+void symbolTableTrackChanges(symbolTableADT table) {
+    table->trackChanges = true;
+}
+
+bool symbolTableEnterScope(symbolTableADT table) {
+    if(!grow((void **) &table->scopeMarks, table->scopeCount, &table->scopeMarksSize, sizeof(uint64_t))) {
+        return false;
+    }
+    table->scopeMarks[table->scopeCount++] = table->undoLogCount;
+    return true;
+}
+
+bool symbolTableExitScope(symbolTableADT table) {
+    if(table->scopeCount == 0) {
+        return true;
+    }
+    return undo(table, table->scopeMarks[--table->scopeCount]);
+}
+
+void symbolTableDestroy(symbolTableADT table) {
+    if(table == NULL) {
+        return;
+    }
+    symbolMapDestroy(table->visible);
+    free(table->symbols);
+    free(table->undoLog);
+    free(table->scopeMarks);
+    free(table->changes);
+    free(table);
 }
@@ -1,33 +1,118 @@
 #ifndef SYMBOL_TABLE_H
 #define SYMBOL_TABLE_H
 #include "hashmap.h"
+#include "interner.h"
 
 struct key {
     char * varname;
 };
 
+// Los nombres llegan internados desde el scanner: el hash ya está calculado y
+// la igualdad es igualdad de punteros.
+static inline uint64_t symbolHashFunction(const struct key * key) {
+    return internedHash(key->varname);
+}
+
+static inline bool symbolKeyEquals(const struct key * key1, const struct key * key2) {
+    return key1->varname == key2->varname;
+}
+
 typedef enum VarType {
     VAR_RBT,
     VAR_BST,
     VAR_AVL,
     VAR_INT,
-    VAR_BOOL
+    VAR_BOOL,
+    // Tipo de una expresión mal formada.
+    VAR_INVALID
 } VarType;
 
 struct metadata {
     bool hasValue;
+    // Los iteradores de un "for" no pueden reasignarse.
+    bool readOnly;
+    // Si se usó dentro de una expresión, y con qué tipo.
+    bool isUsed;
+    VarType expectedType;
 };
 
-struct value {
+/**
+ * Cada símbolo declarado recibe un índice denso, su "slot". El AST referencia slots en lugar de nombres, y
+ * las fases siguientes indexan directamente el arreglo de símbolos.
+ */
+typedef int32_t SymbolId;
+
+#define NO_SYMBOL (-1)
+
+typedef struct {
+    char * varname;
     VarType type;
     struct metadata metadata;
-};
+} Symbol;
+
+// Tabla de símbolos de una compilación.
+typedef struct symbolTableCDT * symbolTableADT;
+
+symbolTableADT symbolTableInit();
+
+// Slot del símbolo visible con ese nombre, o NO_SYMBOL.
+SymbolId symbolTableLookup(symbolTableADT table, char * varname);
+
+// Declara el símbolo en el scope actual, ocultando al visible con ese nombre.
+// Devuelve NO_SYMBOL si no hay memoria.
+SymbolId symbolTableDeclare(symbolTableADT table, char * varname, VarType type, bool hasValue);
+
+// Agrega un símbolo ya declarado en el próximo slot, sin pasar por los
+// scopes. Permite reconstruir los slots de un programa guardado en la caché.
+// Devuelve NO_SYMBOL si no hay memoria.
+SymbolId symbolTableRestore(symbolTableADT table, char * varname, VarType type);
+
+// El puntero deja de ser válido al declarar o referenciar otro símbolo.
+Symbol * symbolTableGet(symbolTableADT table, SymbolId symbol);
+
+// Como "symbolTableGet", para modificar la metadata del símbolo: si la tabla
+// registra cambios, guarda la anterior. Devuelve NULL si no hay memoria.
+Symbol * symbolTableModify(symbolTableADT table, SymbolId symbol);
+
+uint32_t symbolTableSize(symbolTableADT table);
+
+typedef struct {
+    uint32_t symbols;
+    uint64_t undoLogEntries;
+    // Nombres visibles.
+    HashMapStats visible;
+} SymbolTableStats;
+
+void symbolTableStats(symbolTableADT table, SymbolTableStats * stats);
+
+/**
+ * Estado de la tabla en un momento dado, al que se puede volver descartando
+ * los símbolos declarados después y los scopes abiertos después. Para volver
+ * también la metadata de los símbolos anteriores, la tabla debe registrar sus
+ * cambios ("symbolTableTrackChanges") desde antes de la marca.
+ */
+typedef struct {
+    uint32_t symbols;
+    uint64_t undoLogCount;
+    uint64_t scopeCount;
+    uint64_t changeCount;
+} SymbolTableMark;
+
+SymbolTableMark symbolTableMark(symbolTableADT table);
+
+// Devuelve false si no hay memoria; la tabla queda entonces inconsistente.
+bool symbolTableRollback(symbolTableADT table, SymbolTableMark mark);
 
-void symbolTableInit();
+// A partir de ahora "symbolTableModify" registra cada cambio de metadata.
+void symbolTableTrackChanges(symbolTableADT table);
 
-bool symbolTableFind(struct key * key, struct value * value);
+// La tabla comienza con el scope global ya abierto. Devuelve false si no hay
+// memoria.
+bool symbolTableEnterScope(symbolTableADT table);
 
-void symbolTableInsert(struct key * key, struct value * value);
+// Cierra el scope actual, dejando de ver sus símbolos y restaurando los que
+// ocultaban. Los slots se conservan. Devuelve false si no hay memoria.
+bool symbolTableExitScope(symbolTableADT table);
 
-void symbolTableDestroy();
+void symbolTableDestroy(symbolTableADT table);
 #endif
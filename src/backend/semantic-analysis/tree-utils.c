@@ -2,204 +2,93 @@
 #include <assert.h>
 #include "tree-utils.h"
 #include "abstract-syntax-tree.h"
-
-// =========================== Free functions ===========================
-
-void freeProgram(Program *program) {
-    if (program == NULL) {
-        return;
-    }
-
-    freeStatementList(program->statements);
-    free(program);
-}
-
-void freeStatementList(StatementList statementList) {
-    if (statementList == NULL) {
-        return;
-    }
-
-    freeStatementList(statementList->next);
-
-    freeStatement(statementList->statement);
-    free(statementList);
-}
-
-void freeStatement(Statement *statement) {
-    if (statement == NULL) {
-        return;
-    }
-
-    switch (statement->type) {
-        case IF_STATEMENT:
-            freeIfStatement(statement->ifStatement);
-            break;
-        case FOR_STATEMENT:
-            freeForStatement(statement->forStatement);
-            break;
-        case WHILE_STATEMENT:
-            freeWhileStatement(statement->whileStatement);
-            break;
-        case FUNCTION_CALL_STATEMENT:
-            freeFunctionCall(statement->functionCall);
-            break;
-        case DECLARATION_STATEMENT:
-            freeDeclaration(statement->declaration);
-            break;
-        case ASSIGNMENT_STATEMENT:
-            freeAssignment(statement->assignment);
-            break;
-        default:
-            break;
+#include "../support/arena.h"
+
+// El AST completo vive en un unico arena: cada nodo se reserva avanzando un
+// puntero, y al terminar la compilacion se libera todo de una sola vez.
+#define TREE_ARENA_BLOCK_SIZE (64 * 1024)
+
+typedef struct treeCDT {
+    arenaADT arena;
+    TreeStats stats;
+} treeCDT;
+
+static const char * nodeNames[TREE_NODE_TYPES] = {
+    [TREE_PROGRAM] = "Program",
+    [TREE_STATEMENT_LIST] = "StatementNode",
+    [TREE_ASSIGNMENT] = "Assignment",
+    [TREE_FUNCTION_CALL] = "FunctionCall",
+    [TREE_DECLARATION] = "Declaration",
+    [TREE_WHILE] = "WhileStatement",
+    [TREE_FOR] = "ForStatement",
+    [TREE_RANGE] = "RangeExpression",
+    [TREE_IF] = "IfStatement",
+    [TREE_BLOCK] = "Block",
+    [TREE_EXPRESSION] = "Expression",
+    [TREE_FACTOR_EXPRESSION] = "Expression (factor)"
+};
+
+static inline void * NewNode(treeADT tree, TreeNodeType type, uint64_t size) {
+    void * node = arenaAlloc(tree->arena, size);
+    if (node != NULL) {
+        tree->stats.nodes[type]++;
+        tree->stats.bytes[type] += size;
     }
-
-    free(statement);
+    return node;
 }
 
-void freeAssignment(Assignment *assignment) {
-    if (assignment == NULL) {
-        return;
+treeADT treeUtilsInit() {
+    treeADT new = calloc(1, sizeof(treeCDT));
+    if (new == NULL) {
+        return NULL;
     }
-
-    freeExpression(assignment->expression);
-    freeVariable(assignment->varname);
-    freeFunctionCall(assignment->functionCall);
-    free(assignment);
-}
-
-void freeFunctionCall(FunctionCall *functionCall) {
-    if (functionCall == NULL) {
-        return;
+    new->arena = arenaInit(TREE_ARENA_BLOCK_SIZE);
+    if (new->arena == NULL) {
+        free(new);
+        return NULL;
     }
-
-    freeExpression(functionCall->expression);
-    freeVariable(functionCall->varname);
-    freeDeclaration(functionCall->declaration);
-    free(functionCall);
-}
-
-void freeDeclaration(Declaration *declaration) {
-    if (declaration == NULL) {
-        return;
-    }
-
-    freeVariable(declaration->varname);
-    free(declaration);
+    return new;
 }
 
-void freeWhileStatement(WhileStatement *whileStatement) {
-    if (whileStatement == NULL) {
-        return;
-    }
-
-    freeExpression(whileStatement->condition);
-    freeBlock(whileStatement->block);
-    free(whileStatement);
+void treeUtilsReset(treeADT tree) {
+    arenaReset(tree->arena);
 }
 
-void freeForStatement(ForStatement *forStatement) {
-    if (forStatement == NULL) {
-        return;
-    }
-
-    freeRangeExpression(forStatement->range);
-    freeBlock(forStatement->block);
-    free(forStatement);
+void treeUtilsStats(treeADT tree, TreeStats * stats) {
+    *stats = tree->stats;
+    arenaStats(tree->arena, &stats->arena);
 }
 
-void freeRangeExpression(RangeExpression *rangeExpression) {
-    if (rangeExpression == NULL) {
-        return;
-    }
-
-    freeExpression(rangeExpression->expressionLeft);
-    freeExpression(rangeExpression->expressionRight);
-    free(rangeExpression);
+const char * treeUtilsNodeName(TreeNodeType type) {
+    return nodeNames[type];
 }
 
-void freeIfStatement(IfStatement *ifStatement) {
-    if (ifStatement == NULL) {
+void treeUtilsDestroy(treeADT tree) {
+    if (tree == NULL) {
         return;
     }
-
-    freeExpression(ifStatement->condition);
-    freeBlock(ifStatement->blockIf);
-
-    if (ifStatement->type == IF_ELSE_TYPE) {
-        freeBlock(ifStatement->blockElse);
-    }
-    free(ifStatement);
+    arenaDestroy(tree->arena);
+    free(tree);
 }
 
-void freeBlock(Block *block) {
-    if (block == NULL) {
-        return;
-    }
-
-    freeStatementList(block->statements);
-    free(block);
-}
+// =========================== Create functions ===========================
 
-void freeExpression(Expression *expression) {
-    if (expression == NULL) {
-        return;
+Program * createProgram(treeADT tree, StatementList statements) {
+    Program * new = NewNode(tree, TREE_PROGRAM, sizeof(Program));
+    if (new == NULL) {
+        return NULL;
     }
 
-    if (expression->type == FACTOR_EXPRESSION) {
-        freeFactor(expression->factor);
-    } else {
-        freeExpression(expression->leftExpression);
-        freeExpression(expression->rightExpression);
-    }
-
-    free(expression);
-}
-
-void freeFactor(Factor *factor) {
-    if (factor == NULL) {
-        return;
-    }
-
-    switch (factor->type) {
-        case EXPRESSION_FACTOR:
-            freeExpression(factor->expression);
-            break;
-        case VARIABLE_FACTOR:
-            freeVariable(factor->varname);
-            break;
-        case CONSTANT_FACTOR:
-            freeConstant(factor->constant);
-            break;
-    }
-
-    free(factor);
-}
-
-void freeConstant(Constant *constant) {
-    if (constant == NULL) {
-        return;
-    }
-
-    free(constant);
-}
-
-void freeVariable(char *varname) {
-    if (varname == NULL) {
-        return;
-    }
-    free(varname);
-}
-
-Program * createProgram(StatementList statements) {
-    Program * new = malloc(sizeof(Program));
-
     new->statements = statements;
 
     return new;
 }
 
-StatementList createStatementList(Statement * statement, StatementList next) {
-    StatementList new = malloc(sizeof(struct StatementNode));
+StatementList createStatementList(treeADT tree, Statement statement, StatementList next) {
+    StatementList new = NewNode(tree, TREE_STATEMENT_LIST, sizeof(struct StatementNode));
+    if (new == NULL) {
+        return NULL;
+    }
 
     new->statement = statement;
     new->next = next;
@@ -207,58 +96,67 @@ StatementList createStatementList(Statement * statement, StatementList next) {
     return new;
 }
 
-Statement * createStatement(StatementType type, void * statement) {
-    Statement * new = calloc(1, sizeof(Statement));
+Statement createStatement(StatementType type, void * statement) {
+    Statement new = {.type = type};
 
-    new->type = type;
     switch (type) {
-        case IF_STATEMENT: new->ifStatement = statement; break;
-        case FOR_STATEMENT: new->forStatement = statement; break;
-        case WHILE_STATEMENT: new->whileStatement = statement; break;
-        case ASSIGNMENT_STATEMENT: new->assignment = statement; break;
-        case DECLARATION_STATEMENT: new->declaration = statement; break;
-        case FUNCTION_CALL_STATEMENT: new->functionCall = statement; break;
+        case IF_STATEMENT: new.ifStatement = statement; break;
+        case FOR_STATEMENT: new.forStatement = statement; break;
+        case WHILE_STATEMENT: new.whileStatement = statement; break;
+        case ASSIGNMENT_STATEMENT: new.assignment = statement; break;
+        case DECLARATION_STATEMENT: new.declaration = statement; break;
+        case FUNCTION_CALL_STATEMENT: new.functionCall = statement; break;
         default: assert(0 && "Illegal State"); break;
     }
 
     return new;
 }
 
-Assignment * createAssignment(char * varname, Expression * expression, FunctionCall * functionCall) {
-    Assignment * new = malloc(sizeof(Assignment));
+Assignment * createAssignment(treeADT tree, SymbolId symbol, Expression * expression, FunctionCall * functionCall) {
+    Assignment * new = NewNode(tree, TREE_ASSIGNMENT, sizeof(Assignment));
+    if (new == NULL) {
+        return NULL;
+    }
 
-    new->varname = varname;
+    new->symbol = symbol;
     new->expression = expression;
     new->functionCall = functionCall;
 
     return new;
 }
 
-FunctionCall * createFunctionCall(FunctionCallType type, char * varname, Expression * expression, Declaration * declaration) {
-    FunctionCall * new = malloc(sizeof(FunctionCall));
+FunctionCall * createFunctionCall(treeADT tree, FunctionCallType type, SymbolId symbol, Expression * expression, Declaration * declaration) {
+    FunctionCall * new = NewNode(tree, TREE_FUNCTION_CALL, sizeof(FunctionCall));
+    if (new == NULL) {
+        return NULL;
+    }
 
     new->type = type;
-    new->varname = varname;
+    new->symbol = symbol;
     new->expression = expression;
     new->declaration = declaration;
 
     return new;
 }
 
-Declaration * createDeclaration(VarType type, char * varname, Assignment * assignment) {
-    Declaration * new = malloc(sizeof(Declaration));
-
-
+Declaration * createDeclaration(treeADT tree, VarType type, SymbolId symbol, Assignment * assignment) {
+    Declaration * new = NewNode(tree, TREE_DECLARATION, sizeof(Declaration));
+    if (new == NULL) {
+        return NULL;
+    }
 
     new->type = type;
-    new->varname = varname;
+    new->symbol = symbol;
     new->assignment = assignment;
 
     return new;
 }
 
-WhileStatement * createWhileStatement(Expression * condition, Block * block) {
-    WhileStatement * new = malloc(sizeof(WhileStatement));
+WhileStatement * createWhileStatement(treeADT tree, Expression * condition, Block * block) {
+    WhileStatement * new = NewNode(tree, TREE_WHILE, sizeof(WhileStatement));
+    if (new == NULL) {
+        return NULL;
+    }
 
     new->condition = condition;
     new->block = block;
@@ -266,18 +164,24 @@ WhileStatement * createWhileStatement(Expression * condition, Block * block) {
     return new;
 }
 
-ForStatement * createForStatement(char * varname, RangeExpression * range, Block * block) {
-    ForStatement * new = malloc(sizeof(ForStatement));
+ForStatement * createForStatement(treeADT tree, SymbolId symbol, RangeExpression * range, Block * block) {
+    ForStatement * new = NewNode(tree, TREE_FOR, sizeof(ForStatement));
+    if (new == NULL) {
+        return NULL;
+    }
 
-    new->varname = varname;
+    new->symbol = symbol;
     new->block = block;
     new->range = range;
 
     return new;
 }
 
-RangeExpression * createRangeExpression(Expression * left, Expression * right) {
-    RangeExpression * new = malloc(sizeof(RangeExpression));
+RangeExpression * createRangeExpression(treeADT tree, Expression * left, Expression * right) {
+    RangeExpression * new = NewNode(tree, TREE_RANGE, sizeof(RangeExpression));
+    if (new == NULL) {
+        return NULL;
+    }
 
     new->expressionLeft = left;
     new->expressionRight = right;
@@ -285,8 +189,11 @@ RangeExpression * createRangeExpression(Expression * left, Expression * right) {
     return new;
 }
 
-IfStatement * createIfStatement(IfStatementType type, Expression * condition, Block * blockIf, Block * blockElse) {
-    IfStatement * new = malloc(sizeof(IfStatement));
+IfStatement * createIfStatement(treeADT tree, IfStatementType type, Expression * condition, Block * blockIf, Block * blockElse) {
+    IfStatement * new = NewNode(tree, TREE_IF, sizeof(IfStatement));
+    if (new == NULL) {
+        return NULL;
+    }
 
     new->type = type;
     new->condition = condition;
@@ -296,47 +203,66 @@ IfStatement * createIfStatement(IfStatementType type, Expression * condition, Bl
     return new;
 }
 
-Block * createBlock(StatementList statements) {
-    Block * new = malloc(sizeof(Block));
+Block * createBlock(treeADT tree, StatementList statements) {
+    Block * new = NewNode(tree, TREE_BLOCK, sizeof(Block));
+    if (new == NULL) {
+        return NULL;
+    }
 
     new->statements = statements;
 
     return new;
 }
 
-Expression * createExpression(ExpressionType type, Expression * left, Expression * right, Factor * factor) {
-    Expression * new = malloc(sizeof(Expression));
+Expression * createExpression(treeADT tree, ExpressionType type, VarType dataType, Expression * left, Expression * right) {
+    Expression * new = NewNode(tree, TREE_EXPRESSION, sizeof(Expression));
+    if (new == NULL) {
+        return NULL;
+    }
 
     new->type = type;
+    new->dataType = dataType;
     new->leftExpression = left;
     new->rightExpression = right;
+
+    return new;
+}
+
+Expression * createFactorExpression(treeADT tree, VarType dataType, Factor factor) {
+    Expression * new = NewNode(tree, TREE_FACTOR_EXPRESSION, sizeof(Expression));
+    if (new == NULL) {
+        return NULL;
+    }
+
+    new->type = FACTOR_EXPRESSION;
+    new->dataType = dataType;
     new->factor = factor;
 
     return new;
 }
 
-Factor * createFactor(FactorType type, Expression * exp, Constant * con, char * var) {
-    Factor * new = malloc(sizeof(Factor));
+Factor createFactor(FactorType type, Expression * exp, Constant con, SymbolId symbol) {
+    Factor new = {.type = type};
 
-    new->type = type;
-    new->expression = exp;
-    new->constant = con;
-    new->varname = var;
+    switch (type) {
+        case EXPRESSION_FACTOR: new.expression = exp; break;
+        case CONSTANT_FACTOR: new.constant = con; break;
+        case VARIABLE_FACTOR: new.symbol = symbol; break;
+        default: assert(0 && "Illegal State"); break;
+    }
 
     return new;
 }
 
-Constant * createConstant(int intValue, bool boolValue, ConstantType type) {
-    Constant * new = malloc(sizeof(Constant));
+Constant createConstant(int intValue, bool boolValue, ConstantType type) {
+    Constant new = {.type = type};
 
     if (type == INT_CONSTANT) {
-        new->intValue = intValue;
+        new.intValue = intValue;
     } else {
-        new->boolValue = boolValue;
+        new.boolValue = boolValue;
     }
 
-    new->type = type;
-
     return new;
 }
 
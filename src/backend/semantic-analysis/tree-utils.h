@@ -2,66 +2,84 @@
 #define TREE_UTILS_H
 
 #include "abstract-syntax-tree.h"
-
-// ===================== Free functions ========================
-
-void freeProgram(Program * program);
-
-void freeStatementList(StatementList statementList);
-
-void freeStatement(Statement * statement);
-
-void freeAssignment(Assignment * assignment);
-
-void freeFunctionCall(FunctionCall * functionCall);
-
-void freeDeclaration(Declaration * declaration);
-
-void freeWhileStatement(WhileStatement * whileStatement);
-
-void freeForStatement(ForStatement * forStatement);
-
-void freeRangeExpression(RangeExpression * rangeExpression);
-
-void freeIfStatement(IfStatement * ifStatement);
-
-void freeBlock(Block * block);
-
-void freeExpression(Expression * expression);
-
-void freeFactor(Factor * factor);
-
-void freeConstant(Constant *constant);
-
-void freeVariable(char * variable);
+#include "../support/arena.h"
+
+// ===================== Arena ========================
+
+// Todos los nodos del AST se reservan en un arena propio de la compilacion,
+// que se recibe en cada función "create". Además se cuentan los nodos
+// creados de cada tipo.
+typedef struct treeCDT * treeADT;
+
+typedef enum {
+    TREE_PROGRAM = 0,
+    TREE_STATEMENT_LIST,
+    TREE_ASSIGNMENT,
+    TREE_FUNCTION_CALL,
+    TREE_DECLARATION,
+    TREE_WHILE,
+    TREE_FOR,
+    TREE_RANGE,
+    TREE_IF,
+    TREE_BLOCK,
+    TREE_EXPRESSION,
+    TREE_FACTOR_EXPRESSION,
+    TREE_NODE_TYPES
+} TreeNodeType;
+
+typedef struct {
+    // Nodos creados desde "treeUtilsInit" (incluidos los descartados).
+    uint64_t nodes[TREE_NODE_TYPES];
+    uint64_t bytes[TREE_NODE_TYPES];
+    // Estado actual del arena.
+    ArenaStats arena;
+} TreeStats;
+
+treeADT treeUtilsInit();
+
+// Descarta todos los nodos creados hasta el momento (modo "streaming"). Los
+// punteros a nodos previos dejan de ser válidos.
+void treeUtilsReset(treeADT tree);
+
+void treeUtilsStats(treeADT tree, TreeStats * stats);
+
+const char * treeUtilsNodeName(TreeNodeType type);
+
+// Libera de una sola vez todos los nodos creados desde "treeUtilsInit".
+void treeUtilsDestroy(treeADT tree);
 
 // ===================== Create functions ========================
-Program * createProgram(StatementList statements);
+// Las que reservan un nodo devuelven NULL si no hay memoria.
+Program * createProgram(treeADT tree, StatementList statements);
+
+StatementList createStatementList(treeADT tree, Statement statement, StatementList next);
 
-StatementList createStatementList(Statement * statement, StatementList next);
+Statement createStatement(StatementType type, void * statement);
 
-Statement * createStatement(StatementType type, void * statement);
+Assignment * createAssignment(treeADT tree, SymbolId symbol, Expression * expression, FunctionCall * functionCall);
 
-Assignment * createAssignment(char * varname, Expression * expression, FunctionCall * functionCall);
+FunctionCall * createFunctionCall(treeADT tree, FunctionCallType type, SymbolId symbol, Expression * expression, Declaration * declaration);
 
-FunctionCall * createFunctionCall(FunctionCallType type, char * variable, Expression * expression, Declaration * declaration);
+Declaration * createDeclaration(treeADT tree, VarType type, SymbolId symbol, Assignment * assignment);
 
-Declaration * createDeclaration(VarType type, char * variable, Assignment * assignment);
+WhileStatement * createWhileStatement(treeADT tree, Expression * condition, Block * block);
 
-WhileStatement * createWhileStatement(Expression * condition, Block * block);
+ForStatement * createForStatement(treeADT tree, SymbolId symbol, RangeExpression * range, Block * block);
 
-ForStatement * createForStatement(char * variable, RangeExpression * range, Block * block);
+RangeExpression * createRangeExpression(treeADT tree, Expression * expressionLeft, Expression * expressionRight);
 
-RangeExpression * createRangeExpression(Expression * expressionLeft, Expression * expressionRight);
+IfStatement * createIfStatement(treeADT tree, IfStatementType type, Expression * condition, Block * blockIf, Block * blockElse);
 
-IfStatement * createIfStatement(IfStatementType type, Expression * condition, Block * blockIf, Block * blockElse);
+Block * createBlock(treeADT tree, StatementList statements);
 
-Block * createBlock(StatementList statements);
+Expression * createExpression(treeADT tree, ExpressionType type, VarType dataType, Expression * left, Expression * right);
 
-Expression * createExpression(ExpressionType type, Expression * left, Expression * right, Factor * factor);
+Expression * createFactorExpression(treeADT tree, VarType dataType, Factor factor);
 
-Factor * createFactor(FactorType type, Expression * exp, Constant * con, char * var);
+// Los factores y las constantes no se reservan: se guardan dentro de la
+// expresión que los contiene.
+Factor createFactor(FactorType type, Expression * exp, Constant con, SymbolId symbol);
 
-Constant * createConstant(int intValue, bool boolValue, ConstantType type);
+Constant createConstant(int intValue, bool boolValue, ConstantType type);
 
 #endif
@@ -0,0 +1,118 @@
+#include "arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+// Alineacion suficiente para cualquier nodo (gnu99 no dispone de max_align_t).
+typedef union {
+    long double ld;
+    void * ptr;
+    uint64_t u;
+} maxAlign;
+
+#define ALIGNMENT (sizeof(maxAlign))
+#define ALIGN(size) (((size) + ALIGNMENT - 1) & ~(uint64_t)(ALIGNMENT - 1))
+
+typedef struct block {
+    struct block * next;
+    uint64_t size;
+    uint64_t used;
+    maxAlign data[];
+} block;
+
+typedef struct arenaCDT {
+    block * current;
+    uint64_t blockSize;
+} arenaCDT;
+
+static block * newBlock(uint64_t size, block * next) {
+    block * new = malloc(sizeof(block) + size);
+    if(new == NULL) {
+        return NULL;
+    }
+    new->next = next;
+    new->size = size;
+    new->used = 0;
+    return new;
+}
+
+arenaADT arenaInit(uint64_t blockSize) {
+    arenaADT new = malloc(sizeof(arenaCDT));
+    if(new == NULL) {
+        return NULL;
+    }
+    new->blockSize = ALIGN(blockSize);
+    new->current = newBlock(new->blockSize, NULL);
+    if(new->current == NULL) {
+        free(new);
+        return NULL;
+    }
+    return new;
+}
+
+void * arenaAlloc(arenaADT arena, uint64_t size) {
+    size = ALIGN(size);
+    block * current = arena->current;
+    if(current->used + size > current->size) {
+        // Los pedidos mas grandes que un bloque reciben uno propio, que se
+        // encadena detras del actual para no desperdiciar lo que queda libre.
+        if(size > arena->blockSize) {
+            block * big = newBlock(size, current->next);
+            if(big == NULL) {
+                return NULL;
+            }
+            current->next = big;
+            big->used = size;
+            return big->data;
+        }
+        current = newBlock(arena->blockSize, current);
+        if(current == NULL) {
+            return NULL;
+        }
+        arena->current = current;
+    }
+    void * ptr = (char *) current->data + current->used;
+    current->used += size;
+    return ptr;
+}
+
+void arenaReset(arenaADT arena) {
+    // Se conserva un bloque de tamano normal: los pedidos grandes pueden haber
+    // quedado encadenados en cualquier posicion (incluso detras del bloque de
+    // "arenaInit"), y no conviene retener uno de esos.
+    block * kept = NULL;
+    block * current = arena->current;
+    while(current != NULL) {
+        block * next = current->next;
+        if(kept == NULL && current->size == arena->blockSize) {
+            kept = current;
+        } else {
+            free(current);
+        }
+        current = next;
+    }
+    kept->next = NULL;
+    kept->used = 0;
+    arena->current = kept;
+}
+
+void arenaStats(arenaADT arena, ArenaStats * stats) {
+    *stats = (ArenaStats) {0};
+    for(block * current = arena->current; current != NULL; current = current->next) {
+        stats->blocks++;
+        stats->reserved += sizeof(block) + current->size;
+        stats->used += current->used;
+    }
+}
+
+void arenaDestroy(arenaADT arena) {
+    if(arena == NULL) {
+        return;
+    }
+    block * current = arena->current;
+    while(current != NULL) {
+        block * next = current->next;
+        free(current);
+        current = next;
+    }
+    free(arena);
+}
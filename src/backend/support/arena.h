@@ -0,0 +1,33 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * Allocador "bump-pointer": reserva bloques grandes y entrega memoria
+ * avanzando un puntero dentro del bloque actual. No se libera nodo por nodo,
+ * sino todo junto al destruir el arena.
+ */
+
+typedef struct arenaCDT * arenaADT;
+
+typedef struct {
+    uint64_t blocks;
+    // Bytes pedidos al sistema, y cuántos de ellos ya se entregaron.
+    uint64_t reserved;
+    uint64_t used;
+} ArenaStats;
+
+arenaADT arenaInit(uint64_t blockSize);
+
+void * arenaAlloc(arenaADT arena, uint64_t size);
+
+// Descarta todo lo reservado, conservando un solo bloque para reutilizarlo.
+void arenaReset(arenaADT arena);
+
+void arenaStats(arenaADT arena, ArenaStats * stats);
+
+void arenaDestroy(arenaADT arena);
+
+#endif
@@ -1,30 +1,51 @@
 #include "logger.h"
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
 /**
  * Implementación de "logger.h".
  */
 
+int logLevel = LOG_COMPILED_LEVEL;
+
+static const struct {
+	const char * name;
+	const char * prefix;
+} levels[] = {
+	[LOG_LEVEL_DEBUG] = {"debug", "[DEBUG] "},
+	[LOG_LEVEL_INFO] = {"info", "[INFO ] "},
+	[LOG_LEVEL_ERROR] = {"error", "[ERROR] "},
+	[LOG_LEVEL_NONE] = {"none", ""}
+};
+
+bool LogSetLevel(int level) {
+	if (level < LOG_COMPILED_LEVEL || level > LOG_LEVEL_NONE) {
+		return false;
+	}
+	logLevel = level;
+	return true;
+}
+
+int LogLevelFromName(const char * name) {
+	for (int level = LOG_LEVEL_DEBUG; level <= LOG_LEVEL_NONE; ++level) {
+		if (strcmp(levels[level].name, name) == 0) {
+			return level;
+		}
+	}
+	return -1;
+}
+
 void Log(FILE * const stream, const char * prefix, const char * const format, const char * suffix, va_list arguments) {
 	fprintf(stream, "%s", prefix);
 	vfprintf(stream, format, arguments);
 	fprintf(stream, "%s", suffix);
 }
 
-void LogDebug(const char * const format, ...) {
-	#ifdef DEBUG
-	va_list arguments;
-	va_start(arguments, format);
-	Log(stdout, "[DEBUG] ", format, "\n", arguments);
-	va_end(arguments);
-	#endif
-}
-
-void LogError(const char * const format, ...) {
+void LogWrite(int level, const char * const format, ...) {
 	va_list arguments;
 	va_start(arguments, format);
-	Log(stderr, "[ERROR] ", format, "\n", arguments);
+	Log(stderr, levels[level].prefix, format, "\n", arguments);
 	va_end(arguments);
 }
 
@@ -34,10 +55,3 @@ void LogErrorRaw(const char * const format, ...) {
 	Log(stderr, "", format, "", arguments);
 	va_end(arguments);
 }
-
-void LogInfo(const char * const format, ...) {
-	va_list arguments;
-	va_start(arguments, format);
-	Log(stdout, "[INFO ] ", format, "\n", arguments);
-	va_end(arguments);
-}
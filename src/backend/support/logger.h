@@ -1,19 +1,65 @@
 #ifndef LOGGER_HEADER
 #define LOGGER_HEADER
 
+#include <stdarg.h>
+#include <stdbool.h>
 #include <stdio.h>
 
-// Descomentar para loguear en modo DEBUG (con ms detalle).
-#define DEBUG true
+/**
+ * Niveles de log, de más a menos detallado. "LOG_COMPILED_LEVEL" es el nivel
+ * mínimo que se compila: los llamados por debajo de él desaparecen del
+ * binario, incluida la evaluación de sus argumentos. Entre los compilados, se
+ * muestran los que alcanzan el nivel elegido al ejecutar ("LogSetLevel").
+ *
+ * Se elige al compilar con -DLOG_COMPILED_LEVEL=LOG_LEVEL_DEBUG (por
+ * ejemplo); por defecto no se compila el nivel DEBUG.
+ *
+ * Todos los niveles se escriben en la salida de errores: la estándar queda
+ * para el código generado ("--output -") y los resultados de "--batch".
+ */
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_ERROR 2
+#define LOG_LEVEL_NONE 3
 
-void Log(FILE * const stream, const char * prefix, const char * const format, const char * suffix, va_list arguments);
+#ifndef LOG_COMPILED_LEVEL
+#define LOG_COMPILED_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Nivel en ejecución. Es del proceso, no de una compilación: se fija al
+// iniciar, antes de crear hilos.
+extern int logLevel;
 
-void LogDebug(const char * const format, ...);
+// Devuelve false si el nivel no existe o no fue compilado.
+bool LogSetLevel(int level);
+
+// Nivel con ese nombre ("debug", "info", "error" o "none"), o -1.
+int LogLevelFromName(const char * name);
+
+void Log(FILE * const stream, const char * prefix, const char * const format, const char * suffix, va_list arguments);
 
-void LogError(const char * const format, ...);
+void LogWrite(int level, const char * const format, ...) __attribute__((format(printf, 2, 3)));
 
 void LogErrorRaw(const char * const format, ...);
 
-void LogInfo(const char * const format, ...);
+#define LOG_AT(level, ...) do { if (logLevel <= (level)) LogWrite((level), __VA_ARGS__); } while (0)
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_DEBUG
+#define LogDebug(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LogDebug(...) ((void) 0)
+#endif
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_INFO
+#define LogInfo(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LogInfo(...) ((void) 0)
+#endif
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_ERROR
+#define LogError(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LogError(...) ((void) 0)
+#endif
 
 #endif
@@ -0,0 +1,119 @@
+#include "mapped-file.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Bytes '\0' que Flex necesita al final del buffer.
+#define SENTINEL_SIZE 2
+
+typedef struct mappedFileCDT {
+    char * data;
+    uint64_t size;
+    // Largo total de la región reservada (contenido mas centinela).
+    uint64_t length;
+} mappedFileCDT;
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+mappedFileADT mappedFileOpen(const char * path) {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) {
+        return NULL;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(fd);
+        return NULL;
+    }
+    mappedFileADT new = malloc(sizeof(mappedFileCDT));
+    if(new == NULL) {
+        close(fd);
+        return NULL;
+    }
+    new->size = info.st_size;
+    new->length = new->size + SENTINEL_SIZE;
+
+    // Se reserva primero una región anónima con lugar para el centinela y se
+    // mapea el archivo encima: si el tamaño es múltiplo de la página, el
+    // centinela cae en memoria anónima en lugar de pasar el fin del archivo.
+    new->data = mmap(NULL, new->length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(new->data == MAP_FAILED) {
+        close(fd);
+        free(new);
+        return NULL;
+    }
+    if(new->size > 0) {
+        void * mapped = mmap(new->data, new->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+        if(mapped == MAP_FAILED) {
+            munmap(new->data, new->length);
+            close(fd);
+            free(new);
+            return NULL;
+        }
+        madvise(new->data, new->size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+    new->data[new->size] = '\0';
+    new->data[new->size + 1] = '\0';
+    return new;
+}
+
+void mappedFileClose(mappedFileADT file) {
+    if(file == NULL) {
+        return;
+    }
+    munmap(file->data, file->length);
+    free(file);
+}
+
+#else
+
+// Sin "mmap", se lee el archivo completo a memoria.
+mappedFileADT mappedFileOpen(const char * path) {
+    FILE * input = fopen(path, "rb");
+    if(input == NULL) {
+        return NULL;
+    }
+    mappedFileADT new = malloc(sizeof(mappedFileCDT));
+    if(new == NULL || fseek(input, 0, SEEK_END) != 0) {
+        free(new);
+        fclose(input);
+        return NULL;
+    }
+    new->size = ftell(input);
+    new->length = new->size + SENTINEL_SIZE;
+    new->data = malloc(new->length);
+    rewind(input);
+    if(new->data == NULL || fread(new->data, 1, new->size, input) != new->size) {
+        free(new->data);
+        free(new);
+        fclose(input);
+        return NULL;
+    }
+    fclose(input);
+    new->data[new->size] = '\0';
+    new->data[new->size + 1] = '\0';
+    return new;
+}
+
+void mappedFileClose(mappedFileADT file) {
+    if(file == NULL) {
+        return;
+    }
+    free(file->data);
+    free(file);
+}
+
+#endif
+
+char * mappedFileData(mappedFileADT file) {
+    return file->data;
+}
+
+uint64_t mappedFileSize(mappedFileADT file) {
+    return file->size;
+}
@@ -0,0 +1,26 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stdint.h>
+
+/**
+ * Archivo de entrada mapeado en memoria, para escanearlo en el lugar sin
+ * copiarlo. El contenido queda seguido de dos bytes '\0', que es lo que Flex
+ * exige como centinela en "yy_scan_buffer". El mapeo es privado: el scanner
+ * puede escribir sobre él sin modificar el archivo.
+ */
+
+typedef struct mappedFileCDT * mappedFileADT;
+
+// Devuelve NULL si el archivo no se puede abrir o mapear.
+mappedFileADT mappedFileOpen(const char * path);
+
+// Contenido del archivo, seguido de los dos '\0' del centinela.
+char * mappedFileData(mappedFileADT file);
+
+// Tamaño del archivo (sin contar el centinela).
+uint64_t mappedFileSize(mappedFileADT file);
+
+void mappedFileClose(mappedFileADT file);
+
+#endif
@@ -0,0 +1,205 @@
+#include "output-buffer.h"
+#include <errno.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_SIZE 4096
+
+typedef struct outputBufferCDT {
+    char * data;
+    uint64_t length;
+    uint64_t capacity;
+    // Una escritura no tuvo memoria: el contenido quedó incompleto.
+    bool failed;
+} outputBufferCDT;
+
+outputBufferADT outputBufferInit(uint64_t initialSize) {
+    outputBufferADT new = malloc(sizeof(outputBufferCDT));
+    if(new == NULL) {
+        return NULL;
+    }
+    new->capacity = initialSize > 0 ? initialSize : DEFAULT_SIZE;
+    new->data = malloc(new->capacity);
+    if(new->data == NULL) {
+        free(new);
+        return NULL;
+    }
+    new->length = 0;
+    new->data[0] = '\0';
+    new->failed = false;
+    return new;
+}
+
+// Garantiza lugar para "extra" bytes mas el '\0' final. Si no hay memoria,
+// marca el buffer como fallido y las escrituras siguientes se descartan.
+static bool reserve(outputBufferADT buffer, uint64_t extra) {
+    if(buffer->failed) {
+        return false;
+    }
+    uint64_t needed = buffer->length + extra + 1;
+    if(needed <= buffer->capacity) {
+        return true;
+    }
+    uint64_t capacity = buffer->capacity;
+    while(capacity < needed) {
+        capacity *= 2;
+    }
+    char * data = realloc(buffer->data, capacity);
+    if(data == NULL) {
+        buffer->failed = true;
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+void outputBufferWrite(outputBufferADT buffer, const char * data, uint64_t length) {
+    if(!reserve(buffer, length)) {
+        return;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+}
+
+void outputBufferString(outputBufferADT buffer, const char * string) {
+    outputBufferWrite(buffer, string, strlen(string));
+}
+
+void outputBufferChar(outputBufferADT buffer, char c) {
+    if(!reserve(buffer, 1)) {
+        return;
+    }
+    buffer->data[buffer->length++] = c;
+    buffer->data[buffer->length] = '\0';
+}
+
+void outputBufferInteger(outputBufferADT buffer, int value) {
+    // Alcanza para INT_MIN con signo.
+    char digits[12];
+    char * end = digits + sizeof(digits);
+    char * current = end;
+    // Se convierte de atras para adelante y en negativo, para no desbordar
+    // con INT_MIN.
+    int negative = value < 0;
+    int rest = negative ? value : -value;
+    do {
+        *--current = (char) ('0' - rest % 10);
+        rest /= 10;
+    } while(rest != 0);
+    if(negative) {
+        *--current = '-';
+    }
+    outputBufferWrite(buffer, current, end - current);
+}
+
+void outputBufferFormat(outputBufferADT buffer, const char * format, ...) {
+    va_list args;
+    va_start(args, format);
+    outputBufferFormatList(buffer, format, args);
+    va_end(args);
+}
+
+void outputBufferFormatList(outputBufferADT buffer, const char * format, va_list args) {
+    if(buffer->failed) {
+        return;
+    }
+    va_list retry;
+    va_copy(retry, args);
+    uint64_t available = buffer->capacity - buffer->length;
+    int written = vsnprintf(buffer->data + buffer->length, available, format, args);
+    if(written < 0) {
+        buffer->data[buffer->length] = '\0';
+        va_end(retry);
+        return;
+    }
+    if((uint64_t) written >= available) {
+        if(!reserve(buffer, written)) {
+            // Se descarta lo que entró truncado.
+            buffer->data[buffer->length] = '\0';
+            va_end(retry);
+            return;
+        }
+        vsnprintf(buffer->data + buffer->length, written + 1, format, retry);
+    }
+    va_end(retry);
+    buffer->length += written;
+}
+
+const char * outputBufferData(outputBufferADT buffer) {
+    return buffer->data;
+}
+
+uint64_t outputBufferLength(outputBufferADT buffer) {
+    return buffer->length;
+}
+
+bool outputBufferFailed(outputBufferADT buffer) {
+    return buffer->failed;
+}
+
+bool outputBufferFlushToFile(outputBufferADT buffer, FILE * file) {
+    if(buffer->failed) {
+        return false;
+    }
+    if(fwrite(buffer->data, 1, buffer->length, file) != buffer->length) {
+        return false;
+    }
+    return fflush(file) == 0;
+}
+
+bool outputBufferFlushToDescriptor(outputBufferADT buffer, int fd) {
+    if(buffer->failed) {
+        return false;
+    }
+    const char * current = buffer->data;
+    uint64_t remaining = buffer->length;
+    while(remaining > 0) {
+        ssize_t written = write(fd, current, remaining);
+        if(written < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        current += written;
+        remaining -= written;
+    }
+    return true;
+}
+
+bool outputBufferFlushToPath(outputBufferADT buffer, const char * path) {
+    if(buffer->failed) {
+        return false;
+    }
+    FILE * file = fopen(path, "w");
+    if(file == NULL) {
+        return false;
+    }
+    bool ok = outputBufferFlushToFile(buffer, file);
+    return fclose(file) == 0 && ok;
+}
+
+void outputBufferReset(outputBufferADT buffer) {
+    buffer->length = 0;
+    buffer->data[0] = '\0';
+    buffer->failed = false;
+}
+
+void outputBufferTruncate(outputBufferADT buffer, uint64_t length) {
+    if (length < buffer->length) {
+        buffer->length = length;
+        buffer->data[length] = '\0';
+    }
+}
+
+void outputBufferDestroy(outputBufferADT buffer) {
+    if(buffer == NULL) {
+        return;
+    }
+    free(buffer->data);
+    free(buffer);
+}
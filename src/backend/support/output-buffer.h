@@ -0,0 +1,60 @@
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Buffer de salida en memoria que crece a demanda. El generador escribe todo
+ * el programa acá y se vuelca una sola vez al destino (archivo, descriptor o
+ * salida estándar), o se consume directamente desde memoria.
+ *
+ * Si una escritura no consigue memoria, el buffer queda fallido: las
+ * escrituras siguientes se descartan y los volcados devuelven false, hasta
+ * "outputBufferReset".
+ */
+
+typedef struct outputBufferCDT * outputBufferADT;
+
+outputBufferADT outputBufferInit(uint64_t initialSize);
+
+// Escritura sin formato: no pasan por el parser de printf.
+void outputBufferWrite(outputBufferADT buffer, const char * data, uint64_t length);
+
+void outputBufferString(outputBufferADT buffer, const char * string);
+
+void outputBufferChar(outputBufferADT buffer, char c);
+
+void outputBufferInteger(outputBufferADT buffer, int value);
+
+// Escritura con formato, para los casos que no cubren las anteriores.
+void outputBufferFormat(outputBufferADT buffer, const char * format, ...);
+
+void outputBufferFormatList(outputBufferADT buffer, const char * format, va_list args);
+
+// Contenido acumulado (terminado en '\0') y su longitud.
+const char * outputBufferData(outputBufferADT buffer);
+
+uint64_t outputBufferLength(outputBufferADT buffer);
+
+// Indica si alguna escritura se perdió por falta de memoria.
+bool outputBufferFailed(outputBufferADT buffer);
+
+// Vuelcan el contenido y devuelven false si la escritura falla.
+bool outputBufferFlushToFile(outputBufferADT buffer, FILE * file);
+
+bool outputBufferFlushToDescriptor(outputBufferADT buffer, int fd);
+
+bool outputBufferFlushToPath(outputBufferADT buffer, const char * path);
+
+// Descarta el contenido (y el fallo) conservando la memoria reservada.
+void outputBufferReset(outputBufferADT buffer);
+
+// Descarta el contenido a partir de "length" bytes. No borra un fallo.
+void outputBufferTruncate(outputBufferADT buffer, uint64_t length);
+
+void outputBufferDestroy(outputBufferADT buffer);
+
+#endif
@@ -0,0 +1,130 @@
+#include "perf-counters.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+/**
+ * Implementación de "perf-counters.h".
+ */
+
+typedef struct perfCountersCDT {
+	// -1 si el contador no está disponible.
+	int fds[PERF_COUNTERS];
+} perfCountersCDT;
+
+static const char * names[PERF_COUNTERS] = {
+	[PERF_CYCLES] = "ciclos",
+	[PERF_INSTRUCTIONS] = "instrucciones",
+	[PERF_CACHE_MISSES] = "fallos de cache",
+	[PERF_BRANCH_MISSES] = "saltos mal predichos"
+};
+
+#ifdef __linux__
+
+static const uint64_t events[PERF_COUNTERS] = {
+	[PERF_CYCLES] = PERF_COUNT_HW_CPU_CYCLES,
+	[PERF_INSTRUCTIONS] = PERF_COUNT_HW_INSTRUCTIONS,
+	[PERF_CACHE_MISSES] = PERF_COUNT_HW_CACHE_MISSES,
+	[PERF_BRANCH_MISSES] = PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static int OpenCounter(uint64_t event) {
+	struct perf_event_attr attributes;
+	memset(&attributes, 0, sizeof(attributes));
+	attributes.size = sizeof(attributes);
+	attributes.type = PERF_TYPE_HARDWARE;
+	attributes.config = event;
+	// Con "perf_event_paranoid" en 2 solo se permite medir el modo usuario.
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+	attributes.inherit = 1;
+	attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return (int) syscall(SYS_perf_event_open, &attributes, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+
+perfCountersADT perfCountersOpen(const char ** reason) {
+	perfCountersADT counters = malloc(sizeof(perfCountersCDT));
+	if (counters == NULL) {
+		if (reason != NULL) {
+			*reason = "no hay memoria disponible";
+		}
+		return NULL;
+	}
+	int opened = 0;
+	int error = 0;
+	for (int counter = 0; counter < PERF_COUNTERS; ++counter) {
+		counters->fds[counter] = OpenCounter(events[counter]);
+		if (counters->fds[counter] >= 0) {
+			opened++;
+		} else if (error == 0) {
+			error = errno;
+		}
+	}
+	if (opened == 0) {
+		if (reason != NULL) {
+			*reason = error == EACCES || error == EPERM
+				? "sin permiso (ver /proc/sys/kernel/perf_event_paranoid)"
+				: error == ENOENT || error == EOPNOTSUPP || error == ENODEV
+					? "el procesador o la maquina virtual no los ofrece"
+					: strerror(error);
+		}
+		free(counters);
+		return NULL;
+	}
+	return counters;
+}
+
+void perfCountersRead(perfCountersADT counters, PerfSample * sample) {
+	for (int counter = 0; counter < PERF_COUNTERS; ++counter) {
+		// Valor, tiempo habilitado y tiempo efectivamente contando.
+		uint64_t values[3];
+		sample->values[counter] = 0;
+		if (counters->fds[counter] < 0 || read(counters->fds[counter], values, sizeof(values)) != sizeof(values)) {
+			continue;
+		}
+		if (values[2] > 0 && values[2] < values[1]) {
+			values[0] = (uint64_t) ((double) values[0] * values[1] / values[2]);
+		}
+		sample->values[counter] = values[0];
+	}
+}
+
+#else
+
+perfCountersADT perfCountersOpen(const char ** reason) {
+	if (reason != NULL) {
+		*reason = "solo estan disponibles en Linux";
+	}
+	return NULL;
+}
+
+void perfCountersRead(perfCountersADT counters, PerfSample * sample) {
+	memset(sample, 0, sizeof(*sample));
+}
+
+#endif
+
+bool perfCountersAvailable(perfCountersADT counters, PerfCounter counter) {
+	return counters != NULL && counters->fds[counter] >= 0;
+}
+
+const char * perfCounterName(PerfCounter counter) {
+	return names[counter];
+}
+
+void perfCountersClose(perfCountersADT counters) {
+	if (counters == NULL) {
+		return;
+	}
+	for (int counter = 0; counter < PERF_COUNTERS; ++counter) {
+		if (counters->fds[counter] >= 0) {
+			close(counters->fds[counter]);
+		}
+	}
+	free(counters);
+}
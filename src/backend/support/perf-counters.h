@@ -0,0 +1,46 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Contadores de hardware del proceso (perf_event_open, solo en Linux):
+ * ciclos, instrucciones, fallos de caché y predicciones de salto fallidas,
+ * en modo usuario. Incluyen los hilos que se creen después de abrirlos (los
+ * de la generación en paralelo), una vez que terminan.
+ *
+ * Cada contador se abre por separado: si el hardware o el kernel no ofrecen
+ * alguno (máquinas virtuales, "perf_event_paranoid"), se omite y los demás se
+ * siguen midiendo.
+ */
+
+typedef enum {
+	PERF_CYCLES = 0,
+	PERF_INSTRUCTIONS,
+	PERF_CACHE_MISSES,
+	PERF_BRANCH_MISSES,
+	PERF_COUNTERS
+} PerfCounter;
+
+typedef struct {
+	uint64_t values[PERF_COUNTERS];
+} PerfSample;
+
+typedef struct perfCountersCDT * perfCountersADT;
+
+// Devuelve NULL si no se pudo abrir ningún contador; en ese caso "reason"
+// (si no es NULL) describe el motivo.
+perfCountersADT perfCountersOpen(const char ** reason);
+
+bool perfCountersAvailable(perfCountersADT counters, PerfCounter counter);
+
+// Valores acumulados hasta ahora, escalados si el kernel multiplexó los
+// contadores. Los no disponibles quedan en 0.
+void perfCountersRead(perfCountersADT counters, PerfSample * sample);
+
+const char * perfCounterName(PerfCounter counter);
+
+void perfCountersClose(perfCountersADT counters);
+
+#endif
@@ -4,37 +4,12 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include "../semantic-analysis/abstract-syntax-tree.h"
-
-// Descriptor del archivo de entrada que utiliza Bison.
-extern FILE * yyin;
-
-// Descriptor del archivo de salida que utiliza Bison.
-extern FILE * yyout;
-
-// La cantidad de caracteres en el lexema "yytext". Se debe leer en las
-// acciones de Flex, no en Bison.
-// Usamos ifdef para que los que usan mac puedan compilar
-#ifndef MAC_USER
-extern int yyleng;
-#endif
-#ifdef MAC_USER
-extern size_t yyleng;
-#endif
-
-// Variable global que contiene el número de la línea analizada.
-extern int yylineno;
-
-// Token actual en el tope de la pila del analizador Bison.
-extern char * yytext;
-
-// Función global de manejo de errores en Bison.
-extern void yyerror(const char * string);
-
-// Función global del analizador léxico Flex.
-extern int yylex(void);
-
-// Función global del analizador sintáctico Bison.
-extern int yyparse(void);
+#include "../semantic-analysis/ast-cache.h"
+#include "../semantic-analysis/interner.h"
+#include "../semantic-analysis/symbol-table.h"
+#include "../semantic-analysis/tree-utils.h"
+#include "arena.h"
+#include "trace.h"
 
 // Emular tipo "boolean".
 /*
@@ -49,8 +24,23 @@ typedef bool boolean;
 // El tipo de los tokens emitidos por Flex.
 typedef int token;
 
-// Estado global de toda la aplicación.
-typedef struct {
+// Resultado de una compilación.
+typedef enum {
+	COMPILER_OK = 0,
+	COMPILER_SYNTAX_ERROR,
+	COMPILER_SEMANTIC_ERROR,
+	COMPILER_OUT_OF_MEMORY,
+	COMPILER_IO_ERROR
+} CompilerStatus;
+
+#define COMPILER_MESSAGE_SIZE 256
+
+/**
+ * Estado de una compilación. No hay estado global: el parser, el scanner y
+ * todas las acciones reciben este contexto, de modo que varios programas
+ * pueden compilarse a la vez en hilos distintos, cada uno con el suyo.
+ */
+typedef struct CompilerState {
 
 	// Indica si la compilación tuvo problemas hasta el momento.
 	boolean succeed;
@@ -61,14 +51,59 @@ typedef struct {
 	// El nodo raíz del AST (se usará cuando se implemente el backend).
 	Program * program;
 
-	// Agregar lo que sea necesario para el compilador.
-	// Agregar una pila para manipular scopes.
-	// Agregar una tabla de símbolos.
-	// ...
+	// En modo "streaming" no se construye el programa completo: cada sentencia
+	// de primer nivel se entrega a "emitStatement" apenas se reduce, y luego
+	// se descartan sus nodos. Si "emitStatement" es NULL, solo se valida.
+	boolean streaming;
+	void (* emitStatement)(struct CompilerState * state, Statement * statement);
+
+	// Fuera del modo "streaming", si no es NULL, se llama con cada sentencia
+	// de primer nivel apenas se agrega al programa: "end" es el desplazamiento
+	// del fuente donde termina, y "read" hasta dónde se leyó para reconocerla
+	// (el token siguiente incluido). Ambos son SIZE_MAX si la reconoció el fin
+	// del archivo. Ver "compilerResumeBuffer".
+	void (* addStatement)(struct CompilerState * state, StatementList statement, size_t end, size_t read);
+
+	// Dato libre para quien provee "emitStatement" o "addStatement".
+	void * emitData;
+
+	// Medición de las fases ("--time-report"), o NULL. No es de la compilación:
+	// "compilerDestroy" no la libera.
+	traceADT trace;
+
+	// Hilos para generar el código del programa (0 o 1: secuencial).
+	int workers;
+
+	// Identificadores, símbolos y nodos del AST de esta compilación.
+	internerADT interner;
+	symbolTableADT symbols;
+	treeADT tree;
+
+	// Si el programa se cargó desde la caché, sus nodos viven en ella.
+	astCacheADT cache;
+
+	// Primer error encontrado, y la línea donde ocurrió.
+	CompilerStatus status;
+	int errorLine;
+	char errorMessage[COMPILER_MESSAGE_SIZE];
 
 } CompilerState;
 
-// El estado se define e inicializa en el archivo "main.c".
-extern CompilerState state;
+// Scanner reentrante de Flex ("yyscan_t"). Se definen al final de
+// "flex-patterns.l".
+void * ScannerInit(CompilerState * state);
+void ScannerSetFile(void * scanner, FILE * file);
+// Escanea "buffer" en el lugar, sin copiarlo. Los últimos 2 de los "size"
+// bytes deben ser '\0'.
+boolean ScannerSetBuffer(void * scanner, char * buffer, size_t size);
+// Escanea una copia de "source".
+boolean ScannerSetString(void * scanner, const char * source, size_t length);
+int ScannerLine(void * scanner);
+const char * ScannerText(void * scanner);
+// Desplazamientos desde el inicio del buffer donde empieza y termina el último
+// lexema. Solo con "ScannerSetBuffer" o "ScannerSetString".
+size_t ScannerLexemeStart(void * scanner);
+size_t ScannerLexemeEnd(void * scanner);
+void ScannerDestroy(void * scanner);
 
 #endif
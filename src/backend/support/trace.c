@@ -0,0 +1,227 @@
+#include "trace.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * Implementación de "trace.h".
+ */
+
+#define DEFAULT_SPANS 64
+
+// Filas del visor: las fases, y los totales acumulados.
+#define PHASES_THREAD 1
+#define TOTALS_THREAD 2
+
+typedef struct {
+	const char * name;
+	uint32_t depth;
+	uint64_t start;
+	uint64_t end;
+	// Al empezar, los valores de los contadores; al terminar, la diferencia.
+	PerfSample counters;
+} Span;
+
+typedef struct traceCDT {
+	uint64_t origin;
+	Span * spans;
+	uint32_t count;
+	uint32_t capacity;
+	// Índices de los intervalos abiertos, del más externo al más interno.
+	uint32_t * open;
+	uint32_t depth;
+	// Intervalos que no se registraron por falta de memoria, todavía abiertos.
+	// Sus "traceEnd" se ignoran, para no cerrar el intervalo que los contiene.
+	uint32_t dropped;
+	uint64_t totals[TRACE_TOTALS];
+	uint64_t calls[TRACE_TOTALS];
+	bool collectTotals;
+	perfCountersADT counters;
+} traceCDT;
+
+static const char * totalNames[TRACE_TOTALS] = {
+	[TRACE_LEXER] = "Scanner (Flex)",
+	[TRACE_SYMBOLS] = "Chequeos semanticos"
+};
+
+traceADT traceInit(bool totals) {
+	traceADT trace = calloc(1, sizeof(traceCDT));
+	if (trace == NULL) {
+		return NULL;
+	}
+	trace->capacity = DEFAULT_SPANS;
+	trace->spans = malloc(trace->capacity * sizeof(Span));
+	trace->open = malloc(trace->capacity * sizeof(uint32_t));
+	if (trace->spans == NULL || trace->open == NULL) {
+		traceDestroy(trace);
+		return NULL;
+	}
+	trace->collectTotals = totals;
+	trace->origin = traceNow();
+	return trace;
+}
+
+bool traceCollectsTotals(traceADT trace) {
+	return trace != NULL && trace->collectTotals;
+}
+
+void traceUseCounters(traceADT trace, perfCountersADT counters) {
+	if (trace != NULL) {
+		trace->counters = counters;
+	}
+}
+
+uint64_t traceNow() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+void traceBegin(traceADT trace, const char * name) {
+	if (trace == NULL) {
+		return;
+	}
+	// Dentro de un intervalo perdido se pierden también los anidados: así los
+	// "traceEnd" ignorados son exactamente los de los intervalos perdidos.
+	if (trace->dropped > 0) {
+		trace->dropped++;
+		return;
+	}
+	if (trace->count == trace->capacity) {
+		// Sin memoria, el intervalo se pierde pero la medición sigue.
+		uint32_t capacity = trace->capacity * 2;
+		Span * spans = realloc(trace->spans, capacity * sizeof(Span));
+		if (spans != NULL) {
+			trace->spans = spans;
+		}
+		uint32_t * open = spans == NULL ? NULL : realloc(trace->open, capacity * sizeof(uint32_t));
+		if (open == NULL) {
+			trace->dropped++;
+			return;
+		}
+		trace->open = open;
+		trace->capacity = capacity;
+	}
+	Span * span = &trace->spans[trace->count];
+	*span = (Span) {.name = name, .depth = trace->depth};
+	trace->open[trace->depth++] = trace->count++;
+	// Los contadores se leen antes del reloj, para no atribuirle su costo.
+	if (trace->counters != NULL) {
+		perfCountersRead(trace->counters, &span->counters);
+	}
+	span->start = traceNow();
+}
+
+void traceEnd(traceADT trace) {
+	if (trace == NULL) {
+		return;
+	}
+	if (trace->dropped > 0) {
+		trace->dropped--;
+		return;
+	}
+	if (trace->depth == 0) {
+		return;
+	}
+	Span * span = &trace->spans[trace->open[--trace->depth]];
+	span->end = traceNow();
+	if (trace->counters != NULL) {
+		PerfSample now;
+		perfCountersRead(trace->counters, &now);
+		for (int counter = 0; counter < PERF_COUNTERS; ++counter) {
+			// Un contador que no se pudo leer queda en 0.
+			const uint64_t start = span->counters.values[counter];
+			span->counters.values[counter] = now.values[counter] < start ? 0 : now.values[counter] - start;
+		}
+	}
+}
+
+void traceAdd(traceADT trace, TraceTotal total, uint64_t nanoseconds) {
+	if (trace == NULL || !trace->collectTotals) {
+		return;
+	}
+	trace->totals[total] += nanoseconds;
+	trace->calls[total]++;
+}
+
+uint64_t traceTotal(traceADT trace, TraceTotal total) {
+	return trace == NULL ? 0 : trace->totals[total];
+}
+
+// El formato usa microsegundos; se conservan los decimales.
+static double Microseconds(uint64_t nanoseconds) {
+	return nanoseconds / 1000.0;
+}
+
+void traceFinish(traceADT trace) {
+	if (trace != NULL) {
+		trace->dropped = 0;
+	}
+	while (trace != NULL && trace->depth > 0) {
+		traceEnd(trace);
+	}
+}
+
+void traceVisit(traceADT trace, TraceVisitor visitor, void * data) {
+	if (trace == NULL) {
+		return;
+	}
+	traceFinish(trace);
+	for (uint32_t i = 0; i < trace->count; ++i) {
+		const Span * span = &trace->spans[i];
+		visitor(span->name, span->depth, span->end - span->start, trace->counters == NULL ? NULL : &span->counters, data);
+	}
+}
+
+bool traceWrite(traceADT trace, const char * path) {
+	if (trace == NULL) {
+		return false;
+	}
+	traceFinish(trace);
+	FILE * file = fopen(path, "w");
+	if (file == NULL) {
+		return false;
+	}
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Fases\"}},\n", PHASES_THREAD);
+	fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Totales acumulados\"}}", TOTALS_THREAD);
+	for (uint32_t i = 0; i < trace->count; ++i) {
+		const Span * span = &trace->spans[i];
+		fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"fase\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+			span->name, PHASES_THREAD, Microseconds(span->start - trace->origin), Microseconds(span->end - span->start));
+		if (trace->counters != NULL) {
+			const char * separator = "";
+			fprintf(file, ",\"args\":{");
+			for (int counter = 0; counter < PERF_COUNTERS; ++counter) {
+				if (perfCountersAvailable(trace->counters, counter)) {
+					fprintf(file, "%s\"%s\":%" PRIu64, separator, perfCounterName(counter), span->counters.values[counter]);
+					separator = ",";
+				}
+			}
+			fprintf(file, "}");
+		}
+		fprintf(file, "}");
+	}
+	// Los totales se dibujan uno detrás del otro desde el inicio.
+	uint64_t offset = 0;
+	for (int total = 0; total < TRACE_TOTALS; ++total) {
+		if (trace->calls[total] == 0) {
+			continue;
+		}
+		fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"total\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"llamadas\":%" PRIu64 "}}",
+			totalNames[total], TOTALS_THREAD, Microseconds(offset), Microseconds(trace->totals[total]), trace->calls[total]);
+		offset += trace->totals[total];
+	}
+	fprintf(file, "\n]}\n");
+	return fclose(file) == 0;
+}
+
+void traceDestroy(traceADT trace) {
+	if (trace == NULL) {
+		return;
+	}
+	free(trace->spans);
+	free(trace->open);
+	free(trace);
+}
@@ -0,0 +1,73 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "perf-counters.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Medición de las fases de una compilación con un reloj monotónico. Se
+ * exporta en el formato "trace event" (JSON), que abren chrome://tracing y
+ * Perfetto.
+ *
+ * Las fases secuenciales son intervalos anidados ("traceBegin"/"traceEnd").
+ * El scanner y los chequeos semánticos corren intercalados con las acciones
+ * de Bison, así que su tiempo se acumula ("traceAdd") y se informa como un
+ * total, en una fila aparte.
+ *
+ * Con contadores de hardware, cada intervalo registra además los eventos
+ * ocurridos entre su inicio y su fin.
+ *
+ * Todas las funciones aceptan un trace NULL y no hacen nada: así se desactiva.
+ * Un trace no es thread-safe; se usa desde el hilo que compila.
+ */
+
+typedef struct traceCDT * traceADT;
+
+typedef enum {
+	TRACE_LEXER = 0,
+	TRACE_SYMBOLS,
+	TRACE_TOTALS
+} TraceTotal;
+
+// "totals" indica si se acumulan los tiempos intercalados. Medir cada token
+// altera lo que cuentan los contadores de hardware, así que con ellos
+// conviene no hacerlo.
+traceADT traceInit(bool totals);
+
+bool traceCollectsTotals(traceADT trace);
+
+// Los contadores siguen siendo de quien los abrió.
+void traceUseCounters(traceADT trace, perfCountersADT counters);
+
+// Instante actual en nanosegundos.
+uint64_t traceNow();
+
+// El nombre no se copia: debe vivir tanto como el trace. Si no hay memoria,
+// el intervalo y los anidados en él no se registran, y sus "traceEnd" se
+// ignoran.
+void traceBegin(traceADT trace, const char * name);
+
+// Cierra el último intervalo abierto.
+void traceEnd(traceADT trace);
+
+void traceAdd(traceADT trace, TraceTotal total, uint64_t nanoseconds);
+
+// Nanosegundos acumulados hasta ahora en "total".
+uint64_t traceTotal(traceADT trace, TraceTotal total);
+
+// Cierra los intervalos que sigan abiertos.
+void traceFinish(traceADT trace);
+
+// Recorre los intervalos en el orden en que empezaron. "counters" es NULL si
+// no se usaron contadores.
+typedef void (* TraceVisitor)(const char * name, uint32_t depth, uint64_t nanoseconds, const PerfSample * counters, void * data);
+
+void traceVisit(traceADT trace, TraceVisitor visitor, void * data);
+
+// Escribe el JSON en "path", cerrando antes los intervalos abiertos.
+bool traceWrite(traceADT trace, const char * path);
+
+void traceDestroy(traceADT trace);
+
+#endif
@@ -0,0 +1,357 @@
+#include "batch.h"
+#include "compiler.h"
+#include "backend/support/logger.h"
+#include "backend/support/mapped-file.h"
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+// Un programa a compilar, y el resultado de compilarlo.
+typedef struct {
+	char * path;
+	// Dónde se escribe el código generado (NULL con "testMode").
+	char * outputPath;
+	uint64_t size;
+	CompilerStatus status;
+	int errorLine;
+	char errorMessage[COMPILER_MESSAGE_SIZE];
+} BatchJob;
+
+typedef struct {
+	BatchJob * jobs;
+	int count;
+	int capacity;
+} BatchJobs;
+
+/**
+ * Cola de trabajo de cada worker. El dueño toma de "bottom" (los programas
+ * más grandes primero) y los demás roban de "top" cuando se quedan sin
+ * trabajo propio. No se agregan trabajos durante la compilación, así que un
+ * worker termina cuando no encuentra nada en ninguna cola.
+ */
+typedef struct {
+	pthread_mutex_t lock;
+	int * jobs;
+	int top;
+	int bottom;
+} WorkQueue;
+
+typedef struct {
+	BatchJob * jobs;
+	WorkQueue * queues;
+	int workers;
+	const char * outputDirectory;
+	bool testMode;
+} Batch;
+
+typedef struct {
+	Batch * batch;
+	int index;
+} Worker;
+
+static bool AddJob(BatchJobs * jobs, const char * path, uint64_t size) {
+	if (jobs->count == jobs->capacity) {
+		int capacity = jobs->capacity == 0 ? 64 : jobs->capacity * 2;
+		BatchJob * grown = realloc(jobs->jobs, capacity * sizeof(BatchJob));
+		if (grown == NULL) {
+			return false;
+		}
+		jobs->jobs = grown;
+		jobs->capacity = capacity;
+	}
+	BatchJob * job = &jobs->jobs[jobs->count];
+	memset(job, 0, sizeof(BatchJob));
+	job->path = strdup(path);
+	job->size = size;
+	if (job->path == NULL) {
+		return false;
+	}
+	jobs->count++;
+	return true;
+}
+
+// Agrega el archivo, o los archivos del directorio ordenados por nombre.
+static bool CollectJobs(BatchJobs * jobs, const char * path) {
+	struct stat info;
+	if (stat(path, &info) != 0) {
+		LogError("No se pudo acceder a '%s': %s.", path, strerror(errno));
+		return false;
+	}
+	if (!S_ISDIR(info.st_mode)) {
+		return AddJob(jobs, path, info.st_size);
+	}
+	struct dirent ** entries;
+	int entryCount = scandir(path, &entries, NULL, alphasort);
+	if (entryCount < 0) {
+		LogError("No se pudo leer el directorio '%s': %s.", path, strerror(errno));
+		return false;
+	}
+	size_t length = strlen(path);
+	while (length > 1 && path[length - 1] == '/') {
+		length--;
+	}
+	bool collected = true;
+	for (int i = 0; i < entryCount; ++i) {
+		const char * name = entries[i]->d_name;
+		if (collected && name[0] != '.') {
+			char * child = malloc(length + strlen(name) + 2);
+			if (child == NULL) {
+				collected = false;
+			} else {
+				sprintf(child, "%.*s/%s", (int) length, path, name);
+				collected = CollectJobs(jobs, child);
+				free(child);
+			}
+		}
+		free(entries[i]);
+	}
+	free(entries);
+	return collected;
+}
+
+static char * OutputPathOf(const char * outputDirectory, const char * path) {
+	const char * name = path;
+	size_t directoryLength = 0;
+	if (outputDirectory != NULL) {
+		const char * slash = strrchr(path, '/');
+		name = slash == NULL ? path : slash + 1;
+		directoryLength = strlen(outputDirectory) + 1;
+	}
+	char * output = malloc(directoryLength + strlen(name) + sizeof(".java"));
+	if (output == NULL) {
+		return NULL;
+	}
+	if (outputDirectory != NULL) {
+		sprintf(output, "%s/%s.java", outputDirectory, name);
+	} else {
+		sprintf(output, "%s.java", name);
+	}
+	return output;
+}
+
+static void Fail(BatchJob * job, CompilerStatus status, const char * message) {
+	job->status = status;
+	snprintf(job->errorMessage, COMPILER_MESSAGE_SIZE, "%s", message);
+}
+
+static int CompareOutputPaths(const void * left, const void * right) {
+	const BatchJob * a = *(BatchJob * const *) left;
+	const BatchJob * b = *(BatchJob * const *) right;
+	return strcmp(a->outputPath, b->outputPath);
+}
+
+/**
+ * Asigna la salida de cada programa. Con "--output <dir>" solo se conserva el
+ * nombre del archivo, así que dos programas pueden coincidir (por ejemplo,
+ * "a/prog" y "b/prog"): esos se rechazan antes de compilar, en lugar de que
+ * dos workers escriban el mismo archivo a la vez. Un trabajo ya rechazado
+ * queda con un estado distinto de COMPILER_OK.
+ */
+static bool AssignOutputPaths(BatchJob * jobs, int count, const char * outputDirectory) {
+	BatchJob ** sorted = malloc(count * sizeof(BatchJob *));
+	if (sorted == NULL) {
+		return false;
+	}
+	int assigned = 0;
+	for (int i = 0; i < count; ++i) {
+		jobs[i].outputPath = OutputPathOf(outputDirectory, jobs[i].path);
+		if (jobs[i].outputPath == NULL) {
+			Fail(&jobs[i], COMPILER_OUT_OF_MEMORY, "No hay memoria disponible.");
+		} else {
+			sorted[assigned++] = &jobs[i];
+		}
+	}
+	qsort(sorted, assigned, sizeof(BatchJob *), CompareOutputPaths);
+	for (int i = 0; i < assigned; ) {
+		int end = i + 1;
+		while (end < assigned && strcmp(sorted[i]->outputPath, sorted[end]->outputPath) == 0) {
+			end++;
+		}
+		for (int j = i; end - i > 1 && j < end; ++j) {
+			sorted[j]->status = COMPILER_IO_ERROR;
+			snprintf(sorted[j]->errorMessage, COMPILER_MESSAGE_SIZE, "Otro programa del lote escribe la misma salida '%s'.", sorted[j]->outputPath);
+		}
+		i = end;
+	}
+	free(sorted);
+	return true;
+}
+
+static void CompileJob(const Batch * batch, BatchJob * job, outputBufferADT output) {
+	mappedFileADT input = mappedFileOpen(job->path);
+	if (input == NULL) {
+		Fail(job, COMPILER_IO_ERROR, "No se pudo leer el archivo.");
+		return;
+	}
+	CompilerState * state = compilerInit();
+	if (state == NULL) {
+		mappedFileClose(input);
+		Fail(job, COMPILER_OUT_OF_MEMORY, "No hay memoria disponible.");
+		return;
+	}
+	job->status = compilerParseBuffer(state, mappedFileData(input), mappedFileSize(input) + 2);
+	if (job->status == COMPILER_OK && !batch->testMode) {
+		outputBufferReset(output);
+		job->status = compilerGenerate(state, output);
+		if (job->status == COMPILER_OK && !outputBufferFlushToPath(output, job->outputPath)) {
+			Fail(job, COMPILER_IO_ERROR, "No se pudo escribir el codigo generado.");
+		}
+	}
+	if (job->status != COMPILER_OK && job->errorMessage[0] == '\0') {
+		job->errorLine = state->errorLine;
+		memcpy(job->errorMessage, state->errorMessage, COMPILER_MESSAGE_SIZE);
+	}
+	compilerDestroy(state);
+	mappedFileClose(input);
+}
+
+// Devuelve el próximo trabajo de la cola, o -1 si está vacía.
+static int TakeJob(WorkQueue * queue, bool own) {
+	int job = -1;
+	pthread_mutex_lock(&queue->lock);
+	if (queue->top < queue->bottom) {
+		job = own ? queue->jobs[--queue->bottom] : queue->jobs[queue->top++];
+	}
+	pthread_mutex_unlock(&queue->lock);
+	return job;
+}
+
+static void * RunWorker(void * argument) {
+	Worker * worker = argument;
+	Batch * batch = worker->batch;
+	outputBufferADT output = batch->testMode ? NULL : outputBufferInit(0);
+	for (;;) {
+		int job = TakeJob(&batch->queues[worker->index], true);
+		for (int i = 1; job < 0 && i < batch->workers; ++i) {
+			job = TakeJob(&batch->queues[(worker->index + i) % batch->workers], false);
+		}
+		if (job < 0) {
+			break;
+		}
+		if (batch->jobs[job].status != COMPILER_OK) {
+			// Rechazado antes de empezar (ver "AssignOutputPaths").
+			continue;
+		}
+		if (!batch->testMode && output == NULL) {
+			Fail(&batch->jobs[job], COMPILER_OUT_OF_MEMORY, "No hay memoria disponible.");
+			continue;
+		}
+		CompileJob(batch, &batch->jobs[job], output);
+	}
+	outputBufferDestroy(output);
+	return NULL;
+}
+
+typedef struct {
+	uint64_t size;
+	int job;
+} SizedJob;
+
+static int CompareBySize(const void * left, const void * right) {
+	const SizedJob * a = left;
+	const SizedJob * b = right;
+	return (a->size > b->size) - (a->size < b->size);
+}
+
+int CompileBatch(const char ** paths, int count, const char * outputDirectory, bool testMode, int workerCount) {
+	BatchJobs jobs = {0};
+	bool collected = true;
+	for (int i = 0; collected && i < count; ++i) {
+		collected = CollectJobs(&jobs, paths[i]);
+	}
+	if (!collected || jobs.count == 0) {
+		if (collected) {
+			LogError("No hay programas para compilar.");
+		}
+		for (int i = 0; i < jobs.count; ++i) {
+			free(jobs.jobs[i].path);
+		}
+		free(jobs.jobs);
+		return -1;
+	}
+	if (!testMode && !AssignOutputPaths(jobs.jobs, jobs.count, outputDirectory)) {
+		for (int i = 0; i < jobs.count; ++i) {
+			Fail(&jobs.jobs[i], COMPILER_OUT_OF_MEMORY, "No hay memoria disponible.");
+		}
+	}
+	if (workerCount <= 0) {
+		workerCount = 1;
+	}
+	if (workerCount > jobs.count) {
+		workerCount = jobs.count;
+	}
+
+	// Se reparten de menor a mayor, así cada worker empieza por sus programas
+	// más grandes y los que roban se llevan los más chicos.
+	SizedJob * order = malloc(jobs.count * sizeof(SizedJob));
+	int * slots = malloc(jobs.count * sizeof(int));
+	WorkQueue * queues = calloc(workerCount, sizeof(WorkQueue));
+	Worker * workers = calloc(workerCount, sizeof(Worker));
+	pthread_t * threads = calloc(workerCount, sizeof(pthread_t));
+	Batch batch = {jobs.jobs, queues, workerCount, outputDirectory, testMode};
+	int started = 0;
+	if (order != NULL && slots != NULL && queues != NULL && workers != NULL && threads != NULL) {
+		for (int i = 0; i < jobs.count; ++i) {
+			order[i] = (SizedJob) {jobs.jobs[i].size, i};
+		}
+		qsort(order, jobs.count, sizeof(SizedJob), CompareBySize);
+		for (int w = 0, next = 0; w < workerCount; ++w) {
+			pthread_mutex_init(&queues[w].lock, NULL);
+			queues[w].jobs = &slots[next];
+			for (int i = w; i < jobs.count; i += workerCount) {
+				slots[next++] = order[i].job;
+			}
+			queues[w].bottom = &slots[next] - queues[w].jobs;
+		}
+		for (; started < workerCount; ++started) {
+			workers[started] = (Worker) {&batch, started};
+			if (pthread_create(&threads[started], NULL, RunWorker, &workers[started]) != 0) {
+				break;
+			}
+		}
+		// Si no se pudieron crear todos, los que sí se crearon roban el resto.
+		if (started == 0) {
+			workers[0] = (Worker) {&batch, 0};
+			RunWorker(&workers[0]);
+		}
+		for (int i = 0; i < started; ++i) {
+			pthread_join(threads[i], NULL);
+		}
+		for (int w = 0; w < workerCount; ++w) {
+			pthread_mutex_destroy(&queues[w].lock);
+		}
+	} else {
+		for (int i = 0; i < jobs.count; ++i) {
+			Fail(&jobs.jobs[i], COMPILER_OUT_OF_MEMORY, "No hay memoria disponible.");
+		}
+	}
+
+	// Los resultados no pasan por el logger: su formato es fijo y no dependen
+	// del nivel de log, porque otros programas los leen (ver "script/test.sh").
+	int accepted = 0;
+	for (int i = 0; i < jobs.count; ++i) {
+		BatchJob * job = &jobs.jobs[i];
+		if (job->status == COMPILER_OK) {
+			accepted++;
+			printf("Aceptado: %s\n", job->path);
+		} else {
+			printf("Rechazado (estado %d, linea %d): %s: %s\n", job->status, job->errorLine, job->path, job->errorMessage);
+		}
+		free(job->path);
+		free(job->outputPath);
+	}
+	printf("%d de %d programas aceptados (%d workers).\n", accepted, jobs.count, workerCount);
+	fflush(stdout);
+
+	free(jobs.jobs);
+	free(order);
+	free(slots);
+	free(queues);
+	free(workers);
+	free(threads);
+	return accepted == jobs.count ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+#ifndef BATCH_HEADER
+#define BATCH_HEADER
+
+#include <stdbool.h>
+
+/**
+ * Modo "batch": compila muchos programas en un solo proceso, repartidos entre
+ * "workers" hilos. Cada ruta puede ser un archivo o un directorio, que se
+ * recorre recursivamente.
+ *
+ * Cada programa se genera en "<archivo>.java" junto a su fuente, o en
+ * "<outputDirectory>/<nombre>.java" si se indica un directorio; con
+ * "testMode" solo se valida. Los programas que escribirían la misma salida
+ * (mismo nombre en distintos directorios) se rechazan sin compilarse. Al final se escribe en la salida estándar, en el
+ * orden de entrada, una línea "Aceptado: <archivo>" o "Rechazado (estado <n>,
+ * linea <n>): <archivo>: <mensaje>" por programa y un resumen. Este formato
+ * no depende del nivel de log.
+ *
+ * Devuelve 0 si todos los programas fueron aceptados.
+ */
+int CompileBatch(const char ** paths, int count, const char * outputDirectory, bool testMode, int workers);
+
+#endif
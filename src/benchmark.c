@@ -0,0 +1,302 @@
+#include "compiler.h"
+#include "backend/support/logger.h"
+#include "backend/support/output-buffer.h"
+#include "backend/support/trace.h"
+#include "frontend/syntactic-analysis/bison-parser.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Benchmark del compilador: genera programas sintéticos de distintas formas
+ * y tamaños, y mide por separado cada fase sobre varias repeticiones. El
+ * resultado se escribe en JSON para compararlo entre versiones.
+ *
+ * Uso: Benchmark [--shape <forma>] [--size <n>] [--repetitions <n>]
+ *                [--workers <n>] [--output <archivo|->]
+ */
+
+#define DEFAULT_REPETITIONS 10
+
+typedef enum {
+	STAGE_LEX = 0,
+	STAGE_PARSE,
+	STAGE_CHECKS,
+	STAGE_CODEGEN,
+	STAGES
+} Stage;
+
+static const char * stageNames[STAGES] = {
+	[STAGE_LEX] = "lex",
+	[STAGE_PARSE] = "parse",
+	[STAGE_CHECKS] = "checks",
+	[STAGE_CODEGEN] = "codegen"
+};
+
+// Lista larga de sentencias de primer nivel: declaraciones, asignaciones y
+// operaciones sobre árboles.
+static void GenerateList(outputBufferADT program, int size) {
+	for (int i = 0; i < size; ++i) {
+		switch (i % 4) {
+			case 0: outputBufferFormat(program, "int v%d = %d;\n", i, i); break;
+			case 1: outputBufferFormat(program, "v%d = v%d * 2 + 1;\n", i - 1, i - 1); break;
+			case 2: outputBufferFormat(program, "new BST t%d;\n", i); break;
+			default: outputBufferFormat(program, "insert t%d v%d;\n", i - 1, i - 3); break;
+		}
+	}
+}
+
+// Bloques "while" e "if" anidados "size" niveles.
+static void GenerateNested(outputBufferADT program, int size) {
+	outputBufferString(program, "int a = 0;\n");
+	for (int i = 0; i < size; ++i) {
+		outputBufferFormat(program, i % 2 == 0 ? "while (a < %d) {\n" : "if (a > %d) {\n", i);
+	}
+	outputBufferString(program, "a = a + 1;\n");
+	for (int i = 0; i < size; ++i) {
+		outputBufferString(program, "}\n");
+	}
+}
+
+// Una expresión de "size" términos.
+static void GenerateExpression(outputBufferADT program, int size) {
+	static const char * operators[] = {" + ", " * ", " - ", " % "};
+	outputBufferString(program, "int e = 1");
+	for (int i = 1; i < size; ++i) {
+		outputBufferFormat(program, "%s%d", operators[i % 4], i % 97 + 1);
+	}
+	outputBufferString(program, ";\nprint e;\n");
+}
+
+// "size" variables distintas, declaradas y luego usadas: ejercita las tablas
+// de identificadores y de símbolos.
+static void GenerateVariables(outputBufferADT program, int size) {
+	for (int i = 0; i < size; ++i) {
+		outputBufferFormat(program, "int x%d = %d;\n", i, i);
+	}
+	for (int i = 1; i < size; ++i) {
+		outputBufferFormat(program, "x%d = x%d + x%d;\n", i, i - 1, i);
+	}
+}
+
+typedef struct {
+	const char * name;
+	void (* generate)(outputBufferADT program, int size);
+	int defaultSize;
+} Shape;
+
+static const Shape shapes[] = {
+	{"list", GenerateList, 200000},
+	{"nested", GenerateNested, 1000},
+	{"expression", GenerateExpression, 100000},
+	{"variables", GenerateVariables, 100000}
+};
+
+#define SHAPES ((int) (sizeof(shapes) / sizeof(shapes[0])))
+
+typedef struct {
+	double minimum;
+	double median;
+	double mean;
+	double deviation;
+} Summary;
+
+static int CompareDoubles(const void * a, const void * b) {
+	const double x = *(const double *) a;
+	const double y = *(const double *) b;
+	return (x > y) - (x < y);
+}
+
+static Summary Summarize(double * samples, int count) {
+	qsort(samples, count, sizeof(double), CompareDoubles);
+	Summary summary = {.minimum = samples[0]};
+	summary.median = count % 2 == 1 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2;
+	for (int i = 0; i < count; ++i) {
+		summary.mean += samples[i] / count;
+	}
+	for (int i = 0; count > 1 && i < count; ++i) {
+		summary.deviation += (samples[i] - summary.mean) * (samples[i] - summary.mean) / (count - 1);
+	}
+	summary.deviation = sqrt(summary.deviation);
+	return summary;
+}
+
+static double Seconds(uint64_t nanoseconds) {
+	return nanoseconds / 1e9;
+}
+
+// Solo el scanner, con un estado propio para el interner.
+static bool MeasureLex(const char * source, uint64_t length, double * seconds) {
+	CompilerState * state = compilerInit();
+	void * scanner = state == NULL ? NULL : ScannerInit(state);
+	bool measured = scanner != NULL && ScannerSetString(scanner, source, length);
+	if (measured) {
+		YYSTYPE value;
+		const uint64_t start = traceNow();
+		while (yylex(&value, scanner) != 0) {
+		}
+		*seconds = Seconds(traceNow() - start);
+	}
+	ScannerDestroy(scanner);
+	compilerDestroy(state);
+	return measured;
+}
+
+// Análisis completo (scanner, acciones y chequeos), y luego la generación.
+static bool MeasureParseAndGenerate(const char * source, uint64_t length, int workers, outputBufferADT output, double * parse, double * generate) {
+	CompilerState * state = compilerInit();
+	if (state == NULL) {
+		return false;
+	}
+	state->workers = workers;
+	uint64_t start = traceNow();
+	bool measured = compilerParseString(state, source, length) == COMPILER_OK;
+	*parse = Seconds(traceNow() - start);
+	if (measured) {
+		outputBufferReset(output);
+		start = traceNow();
+		measured = compilerGenerate(state, output) == COMPILER_OK;
+		*generate = Seconds(traceNow() - start);
+	}
+	if (!measured) {
+		LogError("El programa generado no compila: %s (linea %d).", state->errorMessage, state->errorLine);
+	}
+	compilerDestroy(state);
+	return measured;
+}
+
+// Los chequeos contra la tabla de símbolos corren intercalados con el
+// análisis: se acumula su tiempo en un análisis aparte, que incluye el costo
+// de medirlos.
+static bool MeasureChecks(const char * source, uint64_t length, double * seconds) {
+	CompilerState * state = compilerInit();
+	traceADT trace = traceInit(true);
+	bool measured = state != NULL && trace != NULL;
+	if (measured) {
+		state->trace = trace;
+		measured = compilerParseString(state, source, length) == COMPILER_OK;
+		*seconds = Seconds(traceTotal(trace, TRACE_SYMBOLS));
+	}
+	compilerDestroy(state);
+	traceDestroy(trace);
+	return measured;
+}
+
+static void WriteSummary(FILE * file, const char * name, const Summary * summary, uint64_t bytes, bool last) {
+	fprintf(file, "        \"%s\": {\"min_ms\": %.3f, \"median_ms\": %.3f, \"mean_ms\": %.3f, \"stddev_ms\": %.3f, \"mb_per_s\": %.2f}%s\n",
+		name, summary->minimum * 1e3, summary->median * 1e3, summary->mean * 1e3, summary->deviation * 1e3,
+		summary->median > 0 ? bytes / summary->median / 1e6 : 0.0, last ? "" : ",");
+}
+
+// Mide una forma y escribe su resultado. Devuelve false si no compila.
+static bool RunShape(FILE * file, const Shape * shape, int size, int repetitions, int workers, bool first) {
+	outputBufferADT program = outputBufferInit(0);
+	outputBufferADT output = outputBufferInit(0);
+	shape->generate(program, size);
+	const char * source = outputBufferData(program);
+	const uint64_t length = outputBufferLength(program);
+
+	double * samples[STAGES];
+	for (int stage = 0; stage < STAGES; ++stage) {
+		samples[stage] = calloc(repetitions, sizeof(double));
+	}
+	// Una repetición descartada, para calentar cachés y el allocador.
+	double discarded[STAGES];
+	bool measured = MeasureLex(source, length, &discarded[STAGE_LEX])
+		&& MeasureParseAndGenerate(source, length, workers, output, &discarded[STAGE_PARSE], &discarded[STAGE_CODEGEN]);
+	for (int i = 0; measured && i < repetitions; ++i) {
+		measured = MeasureLex(source, length, &samples[STAGE_LEX][i])
+			&& MeasureParseAndGenerate(source, length, workers, output, &samples[STAGE_PARSE][i], &samples[STAGE_CODEGEN][i])
+			&& MeasureChecks(source, length, &samples[STAGE_CHECKS][i]);
+	}
+
+	if (measured) {
+		Summary summaries[STAGES];
+		for (int stage = 0; stage < STAGES; ++stage) {
+			summaries[stage] = Summarize(samples[stage], repetitions);
+		}
+		fprintf(file, "%s    {\n", first ? "" : ",\n");
+		fprintf(file, "      \"shape\": \"%s\", \"size\": %d, \"source_bytes\": %" PRIu64 ", \"output_bytes\": %" PRIu64 ",\n",
+			shape->name, size, length, outputBufferLength(output));
+		fprintf(file, "      \"stages\": {\n");
+		for (int stage = 0; stage < STAGES; ++stage) {
+			// La generación se mide contra lo que produce; el resto, contra el fuente.
+			const uint64_t bytes = stage == STAGE_CODEGEN ? outputBufferLength(output) : length;
+			WriteSummary(file, stageNames[stage], &summaries[stage], bytes, stage == STAGES - 1);
+		}
+		fprintf(file, "      }\n    }");
+		LogInfo("%-10s %8d  lex %8.2f ms  parse %8.2f ms  checks %8.2f ms  codegen %8.2f ms (medianas)", shape->name, size,
+			summaries[STAGE_LEX].median * 1e3, summaries[STAGE_PARSE].median * 1e3,
+			summaries[STAGE_CHECKS].median * 1e3, summaries[STAGE_CODEGEN].median * 1e3);
+	}
+
+	for (int stage = 0; stage < STAGES; ++stage) {
+		free(samples[stage]);
+	}
+	outputBufferDestroy(output);
+	outputBufferDestroy(program);
+	return measured;
+}
+
+int main(const int argumentCount, const char ** arguments) {
+	const char * shapeName = NULL;
+	const char * outputPath = "-";
+	int size = 0;
+	int repetitions = DEFAULT_REPETITIONS;
+	int workers = 1;
+	for (int i = 1; i < argumentCount; ++i) {
+		if (strcmp(arguments[i], "--shape") == 0 && i + 1 < argumentCount) {
+			shapeName = arguments[++i];
+		} else if (strcmp(arguments[i], "--size") == 0 && i + 1 < argumentCount) {
+			size = atoi(arguments[++i]);
+		} else if (strcmp(arguments[i], "--repetitions") == 0 && i + 1 < argumentCount) {
+			repetitions = atoi(arguments[++i]);
+		} else if (strcmp(arguments[i], "--workers") == 0 && i + 1 < argumentCount) {
+			workers = atoi(arguments[++i]);
+		} else if (strcmp(arguments[i], "--output") == 0 && i + 1 < argumentCount) {
+			outputPath = arguments[++i];
+		} else {
+			LogError("Argumento desconocido: '%s'.", arguments[i]);
+			return 1;
+		}
+	}
+	if (repetitions < 1) {
+		LogError("Se necesita al menos una repeticion.");
+		return 1;
+	}
+	// Con el JSON en la salida estándar, el resumen no se mezcla con él.
+	const bool toStandardOutput = strcmp(outputPath, "-") == 0;
+	if (toStandardOutput) {
+		LogSetLevel(LOG_LEVEL_ERROR);
+	}
+	FILE * file = toStandardOutput ? stdout : fopen(outputPath, "w");
+	if (file == NULL) {
+		LogError("No se pudo abrir '%s'.", outputPath);
+		return 1;
+	}
+
+	fprintf(file, "{\n  \"repetitions\": %d,\n  \"workers\": %d,\n  \"results\": [\n", repetitions, workers);
+	bool first = true;
+	bool succeed = true;
+	for (int i = 0; i < SHAPES; ++i) {
+		if (shapeName != NULL && strcmp(shapeName, shapes[i].name) != 0) {
+			continue;
+		}
+		if (RunShape(file, &shapes[i], size > 0 ? size : shapes[i].defaultSize, repetitions, workers, first)) {
+			first = false;
+		} else {
+			succeed = false;
+		}
+	}
+	fprintf(file, "\n  ]\n}\n");
+	if (!toStandardOutput && fclose(file) != 0) {
+		LogError("No se pudo escribir '%s'.", outputPath);
+		return 1;
+	}
+	if (first && shapeName != NULL) {
+		LogError("Forma desconocida: '%s'.", shapeName);
+	}
+	return succeed && !first ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+#include "compiler.h"
+#include "backend/code-generation/generator.h"
+#include "backend/semantic-analysis/ast-cache.h"
+#include "backend/semantic-analysis/interner.h"
+#include "backend/semantic-analysis/symbol-table.h"
+#include "backend/semantic-analysis/tree-utils.h"
+#include "backend/support/logger.h"
+#include "frontend/syntactic-analysis/bison-parser.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Implementación de "compiler.h".
+ */
+
+static CompilerStatus Fail(CompilerState * state, CompilerStatus status, const char * message) {
+	if (state->status == COMPILER_OK) {
+		state->status = status;
+		snprintf(state->errorMessage, COMPILER_MESSAGE_SIZE, "%s", message);
+	}
+	return state->status;
+}
+
+// Ejecuta Bison sobre un scanner ya preparado y lo libera.
+static CompilerStatus Parse(CompilerState * state, void * scanner) {
+	traceBegin(state->trace, "Analisis (Flex, Bison y chequeos)");
+	const int result = yyparse(state, scanner);
+	traceEnd(state->trace);
+	// Las acciones semánticas no conocen el scanner: el error se ubica en la
+	// línea donde se abortó el análisis.
+	if (state->status != COMPILER_OK && state->errorLine == 0) {
+		state->errorLine = ScannerLine(scanner);
+	}
+	ScannerDestroy(scanner);
+	switch (result) {
+		case 0:
+			if (!state->succeed) {
+				return Fail(state, COMPILER_SYNTAX_ERROR, "El programa no fue aceptado.");
+			}
+			return state->status;
+		case 2:
+			return Fail(state, COMPILER_OUT_OF_MEMORY, "Bison se quedo sin memoria disponible.");
+		default:
+			// Las acciones o "yyerror" ya registraron el motivo.
+			return Fail(state, COMPILER_SYNTAX_ERROR, "Error de sintaxis.");
+	}
+}
+
+CompilerState * compilerInit() {
+	CompilerState * state = calloc(1, sizeof(CompilerState));
+	if (state == NULL) {
+		return NULL;
+	}
+	state->interner = internerInit();
+	state->symbols = symbolTableInit();
+	state->tree = treeUtilsInit();
+	if (state->interner == NULL || state->symbols == NULL || state->tree == NULL) {
+		compilerDestroy(state);
+		return NULL;
+	}
+	return state;
+}
+
+CompilerStatus compilerParseFile(CompilerState * state, FILE * file) {
+	void * scanner = ScannerInit(state);
+	if (scanner == NULL) {
+		return Fail(state, COMPILER_OUT_OF_MEMORY, "No se pudo crear el scanner.");
+	}
+	ScannerSetFile(scanner, file);
+	return Parse(state, scanner);
+}
+
+CompilerStatus compilerParseBuffer(CompilerState * state, char * buffer, size_t size) {
+	void * scanner = ScannerInit(state);
+	if (scanner == NULL) {
+		return Fail(state, COMPILER_OUT_OF_MEMORY, "No se pudo crear el scanner.");
+	}
+	if (!ScannerSetBuffer(scanner, buffer, size)) {
+		ScannerDestroy(scanner);
+		return Fail(state, COMPILER_IO_ERROR, "El buffer de entrada no termina con dos '\\0'.");
+	}
+	return Parse(state, scanner);
+}
+
+CompilerStatus compilerParseString(CompilerState * state, const char * source, size_t length) {
+	void * scanner = ScannerInit(state);
+	if (scanner == NULL) {
+		return Fail(state, COMPILER_OUT_OF_MEMORY, "No se pudo crear el scanner.");
+	}
+	if (!ScannerSetString(scanner, source, length)) {
+		ScannerDestroy(scanner);
+		return Fail(state, COMPILER_OUT_OF_MEMORY, "No se pudo copiar la entrada.");
+	}
+	return Parse(state, scanner);
+}
+
+CompilerStatus compilerParseBufferCached(CompilerState * state, char * buffer, size_t size, const char * cacheDirectory) {
+	if (state->streaming || cacheDirectory == NULL) {
+		return compilerParseBuffer(state, buffer, size);
+	}
+	// El hash se calcula antes de analizar: Flex escribe sobre el buffer.
+	const uint64_t length = size - 2;
+	const uint64_t hash = astCacheHash(buffer, length);
+	char * path = malloc(strlen(cacheDirectory) + sizeof("/0123456789abcdef.ast"));
+	if (path == NULL) {
+		return Fail(state, COMPILER_OUT_OF_MEMORY, "No hay memoria disponible.");
+	}
+	sprintf(path, "%s/%016" PRIx64 ".ast", cacheDirectory, hash);
+	traceBegin(state->trace, "Carga desde la cache");
+	state->cache = astCacheLoad(path, hash, buffer, length, state->symbols);
+	traceEnd(state->trace);
+	if (state->cache != NULL) {
+		LogDebug("AST cargado desde la cache '%s'.", path);
+		state->program = astCacheProgram(state->cache);
+		state->succeed = true;
+		free(path);
+		return COMPILER_OK;
+	}
+	// La caché guarda el fuente original, que hay que copiar antes de que
+	// Flex lo modifique.
+	char * source = malloc(length == 0 ? 1 : length);
+	if (source != NULL) {
+		memcpy(source, buffer, length);
+	}
+	const CompilerStatus status = compilerParseBuffer(state, buffer, size);
+	// Una caché que no se puede escribir no impide compilar.
+	if (status == COMPILER_OK && source != NULL) {
+		traceBegin(state->trace, "Escritura de la cache");
+		if (!astCacheStore(path, hash, source, length, state->program, state->symbols)) {
+			LogDebug("No se pudo guardar la cache '%s'.", path);
+		}
+		traceEnd(state->trace);
+	}
+	free(source);
+	free(path);
+	return status;
+}
+
+CompilerStatus compilerResumeBuffer(CompilerState * state, StatementList last, SymbolTableMark mark, char * buffer, size_t size) {
+	if (state->streaming || state->cache != NULL || state->program == NULL || state->status != COMPILER_OK) {
+		return Fail(state, COMPILER_SEMANTIC_ERROR, "No hay un analisis previo para retomar.");
+	}
+	StatementList first = state->program->statements;
+	if (!symbolTableRollback(state->symbols, mark)) {
+		return Fail(state, COMPILER_OUT_OF_MEMORY, "No hay memoria disponible.");
+	}
+	last->next = NULL;
+	state->program = NULL;
+	state->succeed = false;
+	const CompilerStatus status = compilerParseBuffer(state, buffer, size);
+	// El análisis produjo un programa con las sentencias nuevas, que se
+	// enganchan a continuación de las conservadas.
+	if (status == COMPILER_OK) {
+		last->next = state->program->statements;
+		state->program->statements = first;
+	}
+	return status;
+}
+
+CompilerStatus compilerGenerate(CompilerState * state, outputBufferADT output) {
+	if (state->status != COMPILER_OK) {
+		return state->status;
+	}
+	if (state->program == NULL) {
+		return Fail(state, COMPILER_SEMANTIC_ERROR, "No hay un programa analizado para generar.");
+	}
+	Generator generator = {.output = output, .symbols = state->symbols, .workers = state->workers, .trace = state->trace};
+	traceBegin(state->trace, "Generacion de codigo");
+	GeneratorProgram(&generator, state->program);
+	traceEnd(state->trace);
+	if (GeneratorFailed(&generator)) {
+		return Fail(state, COMPILER_OUT_OF_MEMORY, "No hay memoria para generar el codigo.");
+	}
+	return COMPILER_OK;
+}
+
+void compilerDestroy(CompilerState * state) {
+	if (state == NULL) {
+		return;
+	}
+	astCacheClose(state->cache);
+	treeUtilsDestroy(state->tree);
+	symbolTableDestroy(state->symbols);
+	internerDestroy(state->interner);
+	free(state);
+}
@@ -0,0 +1,67 @@
+#ifndef COMPILER_HEADER
+#define COMPILER_HEADER
+
+#include "backend/support/shared.h"
+#include "backend/support/output-buffer.h"
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * Interfaz de la librería "tla". Cada compilación tiene su propio
+ * "CompilerState", así que un programa que embebe el compilador puede crear
+ * varios y usarlos desde hilos distintos. Ninguna función termina el proceso:
+ * los errores se devuelven como "CompilerStatus", con el detalle en
+ * "state->errorMessage" y "state->errorLine".
+ *
+ * Uso típico:
+ *
+ *	CompilerState * state = compilerInit();
+ *	if (compilerParseFile(state, file) == COMPILER_OK) {
+ *		compilerGenerate(state, output);
+ *	}
+ *	compilerDestroy(state);
+ *
+ * Cada estado admite un único análisis, salvo "compilerResumeBuffer". Para el
+ * modo "streaming" se setean "streaming", "emitStatement" y "emitData" antes de
+ * analizar, y "workers" para generar el código de programas grandes en
+ * paralelo.
+ */
+
+// Devuelve NULL si no hay memoria disponible.
+CompilerState * compilerInit();
+
+CompilerStatus compilerParseFile(CompilerState * state, FILE * file);
+
+// Analiza "buffer" en el lugar, sin copiarlo. Los últimos 2 de los "size"
+// bytes deben ser '\0' (ver "mappedFileData").
+CompilerStatus compilerParseBuffer(CompilerState * state, char * buffer, size_t size);
+
+// Analiza una copia de los "length" bytes de "source".
+CompilerStatus compilerParseString(CompilerState * state, const char * source, size_t length);
+
+// Como "compilerParseBuffer", pero si "cacheDirectory" tiene el AST de un
+// fuente idéntico lo carga en lugar de analizarlo; si no, lo analiza y guarda
+// el resultado ahí. No aplica al modo "streaming", que no conserva el AST.
+CompilerStatus compilerParseBufferCached(CompilerState * state, char * buffer, size_t size, const char * cacheDirectory);
+
+/**
+ * Retoma un análisis exitoso para volver a compilar un fuente que solo cambió
+ * después de la sentencia de primer nivel "last" (ver "addStatement"): se
+ * conservan el programa hasta ella, inclusive, y la tabla de símbolos vuelve a
+ * "mark", tomada con "symbolTableMark" al agregarla. Luego se analiza "buffer"
+ * (como en "compilerParseBuffer") como la continuación del programa; los
+ * desplazamientos que recibe "addStatement" son relativos a él. La tabla debe
+ * registrar sus cambios ("symbolTableTrackChanges") desde el primer análisis.
+ *
+ * Si falla, el estado solo puede destruirse. Los nodos descartados siguen en
+ * el arena hasta entonces.
+ */
+CompilerStatus compilerResumeBuffer(CompilerState * state, StatementList last, SymbolTableMark mark, char * buffer, size_t size);
+
+// Genera el código del programa analizado al final de "output". Si falta
+// memoria devuelve COMPILER_OUT_OF_MEMORY, y "output" queda incompleto.
+CompilerStatus compilerGenerate(CompilerState * state, outputBufferADT output);
+
+void compilerDestroy(CompilerState * state);
+
+#endif
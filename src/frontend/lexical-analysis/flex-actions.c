@@ -1,4 +1,6 @@
 #include "../../backend/support/logger.h"
+#include "../../backend/semantic-analysis/interner.h"
+#include "../syntactic-analysis/bison-actions.h"
 #include "flex-actions.h"
 #include <stdlib.h>
 #include <string.h>
@@ -10,11 +12,11 @@
  * de tokens hacia Bison:
  *
  *	1) Computar los atributos del token y almacenarlos donde sea conveniente
- *		(en la tabla de símbolos, en "yylval", o en ambos).
+ *		(en la tabla de símbolos, en "lval", o en ambos).
  *	2) Retornar el token que identifica el terminal identificado.
  *
  * Bison utilizará el token retornado en el punto (2) para matchear dicho
- * terminal en la gramática. Por otro lado, el valor almacenado en "yylval" es
+ * terminal en la gramática. Por otro lado, el valor almacenado en "lval" es
  * el que Bison proveerá como valor semántico al realizar una reducción
  * (mediante $1, $2, $3, etc.).
  */
@@ -27,66 +29,69 @@ void EndCommentPatternAction() {
 	LogDebug("EndCommentPatternAction.");
 }
 
-token AdditionOperatorPatternAction(const char * lexeme) {
+token AdditionOperatorPatternAction(YYSTYPE * lval, const char * lexeme) {
 	LogDebug("AdditionOperatorPatternAction: '%s'.", lexeme);
-	yylval.token = ADD;
+	lval->token = ADD;
 	return ADD;
 }
 
-token CloseParenthesisPatternAction(const char * lexeme) {
+token CloseParenthesisPatternAction(YYSTYPE * lval, const char * lexeme) {
 	LogDebug("CloseParenthesisPatternAction: '%s'.", lexeme);
-	yylval.token = CLOSE_PARENTHESIS;
+	lval->token = CLOSE_PARENTHESIS;
 	return CLOSE_PARENTHESIS;
 }
 
-token DivisionOperatorPatternAction(const char * lexeme) {
+token DivisionOperatorPatternAction(YYSTYPE * lval, const char * lexeme) {
 	LogDebug("DivisionOperatorPatternAction: '%s'.", lexeme);
-	yylval.token = DIV;
+	lval->token = DIV;
 	return DIV;
 }
 
-token IntegerPatternAction(const char * lexeme, const int length) {
+token IntegerPatternAction(YYSTYPE * lval, const char * lexeme, const int length) {
 	LogDebug("IntegerPatternAction: '%s' (length = %d).", lexeme, length);
-	yylval.integer = atoi(lexeme);
+	lval->integer = atoi(lexeme);
 	return INTEGER;
 }
 
-token BooleanPatternAction(const char * lexeme, const int length) {
+token BooleanPatternAction(YYSTYPE * lval, const char * lexeme, const int length) {
     LogDebug("BooleanPatternAction: '%s' (length = %d).", lexeme, length);
     bool isTrue = (strcmp(lexeme, "true") == 0);
-    yylval.boolean = isTrue;
+    lval->boolean = isTrue;
     return BOOLEAN;
 }
 
-token MultiplicationOperatorPatternAction(const char * lexeme) {
+token MultiplicationOperatorPatternAction(YYSTYPE * lval, const char * lexeme) {
 	LogDebug("MultiplicationOperatorPatternAction: '%s'.", lexeme);
-	yylval.token = MUL;
+	lval->token = MUL;
 	return MUL;
 }
 
-token OpenParenthesisPatternAction(const char * lexeme) {
+token OpenParenthesisPatternAction(YYSTYPE * lval, const char * lexeme) {
 	LogDebug("OpenParenthesisPatternAction: '%s'.", lexeme);
-	yylval.token = OPEN_PARENTHESIS;
+	lval->token = OPEN_PARENTHESIS;
 	return OPEN_PARENTHESIS;
 }
 
-token SubtractionOperatorPatternAction(const char * lexeme) {
+token SubtractionOperatorPatternAction(YYSTYPE * lval, const char * lexeme) {
 	LogDebug("SubtractionOperatorPatternAction: '%s'.", lexeme);
-	yylval.token = SUB;
+	lval->token = SUB;
 	return SUB;
 }
 
-token DeclarePatternAction(const char* lexeme, const int length) {
+token DeclarePatternAction(CompilerState * state, YYSTYPE * lval, const char * lexeme, const int length) {
     LogDebug("DeclarePatternAction: '%s' (length = %d).", lexeme, length);
-    char * varName = (char*) calloc((length + 1), sizeof(char));
-    strncpy(varName, lexeme, length);
-    yylval.varname = varName;
+    lval->varname = internString(state->interner, lexeme, length);
+    if (lval->varname == NULL) {
+        // Bison aborta con este token; "yyerror" conserva el error registrado.
+        OutOfMemoryError(state);
+        return YYUNDEF;
+    }
     return VARIABLE;
 }
 
-token UnknownPatternAction(const char * lexeme, const int length) {
+token UnknownPatternAction(YYSTYPE * lval, const char * lexeme, const int length) {
 	LogDebug("UnknownPatternAction: '%s' (length = %d).", lexeme, length);
-	yylval.token = YYUNDEF;
+	lval->token = YYUNDEF;
 	// Al emitir este token, el compilador aborta la ejecución.
 	return YYUNDEF;
 }
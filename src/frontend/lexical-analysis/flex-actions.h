@@ -17,28 +17,31 @@
  * emplean el parámetro adicional "length". Esto es útil cuando se desea
  * asignar memoria dinámica, y por lo tanto, se debe saber exactamente el
  * largo de aquello que se va a almacenar.
+ *
+ * Como el analizador es reentrante, las acciones que producen un valor
+ * semántico lo escriben en "lval", provisto por Bison en cada llamada.
  */
 
 
 //Declaracion de nombres de variablez
- token DeclarePatternAction(const char* lexeme, const int length);
+token DeclarePatternAction(CompilerState * state, YYSTYPE * lval, const char * lexeme, const int length);
 
 // Bloque de comentarios multilínea.
 void BeginCommentPatternAction();
 void EndCommentPatternAction();
 
 // Patrones terminales del lenguaje diseñado.
-token AdditionOperatorPatternAction(const char * lexeme);
-token CloseParenthesisPatternAction(const char * lexeme);
-token DivisionOperatorPatternAction(const char * lexeme);
-token IntegerPatternAction(const char * lexeme, const int length);
-token BooleanPatternAction(const char * lexeme, const int length);
-token MultiplicationOperatorPatternAction(const char * lexeme);
-token OpenParenthesisPatternAction(const char * lexeme);
-token SubtractionOperatorPatternAction(const char * lexeme);
+token AdditionOperatorPatternAction(YYSTYPE * lval, const char * lexeme);
+token CloseParenthesisPatternAction(YYSTYPE * lval, const char * lexeme);
+token DivisionOperatorPatternAction(YYSTYPE * lval, const char * lexeme);
+token IntegerPatternAction(YYSTYPE * lval, const char * lexeme, const int length);
+token BooleanPatternAction(YYSTYPE * lval, const char * lexeme, const int length);
+token MultiplicationOperatorPatternAction(YYSTYPE * lval, const char * lexeme);
+token OpenParenthesisPatternAction(YYSTYPE * lval, const char * lexeme);
+token SubtractionOperatorPatternAction(YYSTYPE * lval, const char * lexeme);
 
 // Patrón desconocido, permite abortar debido a un error de sintaxis.
-token UnknownPatternAction(const char * lexeme, const int length);
+token UnknownPatternAction(YYSTYPE * lval, const char * lexeme, const int length);
 
 // Regla que no hace nada, permite ignorar parte de la entrada.
 void IgnoredPatternAction(const char * lexeme, const int length);
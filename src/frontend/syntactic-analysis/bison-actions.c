@@ -3,7 +3,9 @@
 #include "../../backend/semantic-analysis/symbol-table.h"
 #include "../../backend/semantic-analysis/tree-utils.h"
 #include "../../backend/support/logger.h"
+#include "../../backend/support/trace.h"
 #include <assert.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -15,29 +17,65 @@
 /**
  * Esta función se ejecuta cada vez que se emite un error de sintaxis.
  */
-void yyerror(const char *string) {
-    LogError("Mensaje: '%s' debido a '%s' (linea %d).", string, yytext, yylineno);
-    LogError("En ASCII es:");
-    LogErrorRaw("\t");
-    const int length = strlen(yytext);
-    for (int i = 0; i < length; ++i) {
-        LogErrorRaw("[%d]", yytext[i]);
+void yyerror(CompilerState *state, void *scanner, const char *string) {
+    if (state->status != COMPILER_OK) {
+        return;
     }
-    LogErrorRaw("\n\n");
+    state->status = COMPILER_SYNTAX_ERROR;
+    state->errorLine = ScannerLine(scanner);
+    snprintf(state->errorMessage, COMPILER_MESSAGE_SIZE, "Mensaje: '%s' debido a '%s' (linea %d).",
+             string, ScannerText(scanner), state->errorLine);
 }
 
-/* Vector de variables usadas. */
-static struct key *usedSymbols;
-static VarType *usedSymbolsExpectedType;
-static int usedSymbolsCount = 0;
+void SemanticError(CompilerState *state, const char *format, ...) {
+    if (state->status != COMPILER_OK) {
+        return;
+    }
+    state->status = COMPILER_SEMANTIC_ERROR;
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(state->errorMessage, COMPILER_MESSAGE_SIZE, format, arguments);
+    va_end(arguments);
+}
+
+void OutOfMemoryError(CompilerState *state) {
+    if (state->status != COMPILER_OK) {
+        return;
+    }
+    state->status = COMPILER_OUT_OF_MEMORY;
+    snprintf(state->errorMessage, COMPILER_MESSAGE_SIZE, "No hay memoria disponible.");
+}
 
 /* Funciones auxiliares para la construcción del AST. */
-static inline VarType SymbolTableDeclareAux(char *varname, DeclarationType type, bool hasValue);
+static inline SymbolId SymbolTableDeclareAux(CompilerState *state, char *varname, DeclarationType type, bool hasValue);
+static SymbolId SymbolTableFindAux(CompilerState *state, char *varname);
+
+static void AddUsedSymbol(CompilerState *state, SymbolId symbol, VarType expectedType);
+static VarType InferExpressionType(ExpressionType type, Expression *left, Expression *right);
+static VarType InferFactorType(CompilerState *state, const Factor *factor);
+static VarType getFunctionCallType(FunctionCall *functionCall);
+static void ValidateUsedSymbols(CompilerState *state);
+
+// Un nodo recién creado: si no hubo memoria, registra el error para que la
+// gramática aborte el análisis.
+static inline void *Allocated(CompilerState *state, void *node) {
+    if (node == NULL) {
+        OutOfMemoryError(state);
+    }
+    return node;
+}
+
+// Con "--time-report", el tiempo de los chequeos contra la tabla de símbolos
+// se acumula como un total: corren intercalados con el resto de las acciones.
+static inline uint64_t BeginCheck(CompilerState *state) {
+    return state->trace == NULL || !traceCollectsTotals(state->trace) ? 0 : traceNow();
+}
 
-static void AddUsedSymbol(char *varname, VarType expectedType);
-static int getExpressionType(Expression *expression);
-static int getFunctionCallType(FunctionCall *functionCall);
-static void ValidateUsedSymbols();
+static inline void EndCheck(CompilerState *state, uint64_t start) {
+    if (start != 0) {
+        traceAdd(state->trace, TRACE_SYMBOLS, traceNow() - start);
+    }
+}
 
 /**
  * Esta acción se corresponde con el no-terminal que representa el símbolo
@@ -45,21 +83,22 @@ static void ValidateUsedSymbols();
  * indica que efectivamente el programa de entrada se pudo generar con esta
  * gramática, o lo que es lo mismo, que el programa pertenece al lenguaje.
  */
-Program *ProgramGrammarAction(StatementList statements) {
+Program *ProgramGrammarAction(CompilerState *state, StatementList statements) {
     LogDebug("\tProgramGrammarAction");
 
-    ValidateUsedSymbols();
-
-    free(usedSymbols);
-    free(usedSymbolsExpectedType);
+    traceBegin(state->trace, "Validacion de simbolos usados");
+    ValidateUsedSymbols(state);
+    traceEnd(state->trace);
+    if (state->status != COMPILER_OK) {
+        return NULL;
+    }
 
     /*
-     * "state" es una variable global que almacena el estado del compilador,
-     * cuyo campo "succeed" indica si la compilación fue o no exitosa, la cual
-     * es utilizada en la función "main".
+     * "state" es el estado de esta compilación, cuyo campo "succeed" indica si
+     * la compilación fue o no exitosa.
      */
-    state.succeed = true;
-    state.program = createProgram(statements);
+    state->program = Allocated(state, createProgram(state->tree, statements));
+    state->succeed = state->program != NULL;
     /*
      * Por otro lado, "result" contiene el resultado de aplicar el análisis
      * sintáctico mediante Bison, y almacenar el nood raíz del AST construido
@@ -67,137 +106,208 @@ Program *ProgramGrammarAction(StatementList statements) {
      * la expresión se computa on-the-fly, y es la razón por la cual esta
      * variable es un simple entero, en lugar de un nodo.
      */
-    // state.result = value;
+    // state->result = value;
     // return value;
-    return state.program;
+    return state->program;
 }
 
-Block *BlockGrammarAction(StatementList statements) {
+void BeginBlockGrammarAction(CompilerState *state) {
+    LogDebug("\tBeginBlockGrammarAction");
+    if (!symbolTableEnterScope(state->symbols)) {
+        OutOfMemoryError(state);
+    }
+}
+
+Block *BlockGrammarAction(CompilerState *state, StatementList statements) {
     LogDebug("\tBlockGrammarAction");
-    return createBlock(statements);
+    if (!symbolTableExitScope(state->symbols)) {
+        OutOfMemoryError(state);
+        return NULL;
+    }
+    return Allocated(state, createBlock(state->tree, statements));
 }
 
-StatementList StatementListGrammarAction(Statement *statement, StatementList next) {
+StatementSequence StatementListGrammarAction(CompilerState *state, StatementSequence list, Statement statement) {
     LogDebug("\tStatementListGrammarAction");
-    return createStatementList(statement, next);
+    StatementList node = Allocated(state, createStatementList(state->tree, statement, NULL));
+    if (node == NULL) {
+        return list;
+    }
+    if (list.first == NULL) {
+        list.first = node;
+    } else {
+        list.last->next = node;
+    }
+    list.last = node;
+    return list;
 }
 
-Statement *StatementGrammarAction(void *statement, StatementType type) {
+StatementSequence TopLevelStatementGrammarAction(CompilerState *state, StatementSequence list, Statement statement, size_t end, size_t read) {
+    LogDebug("\tTopLevelStatementGrammarAction");
+    if (!state->streaming) {
+        list = StatementListGrammarAction(state, list, statement);
+        if (state->status == COMPILER_OK && state->addStatement != NULL) {
+            state->addStatement(state, list.last, end, read);
+        }
+        return list;
+    }
+    // La sentencia ya pasó sus validaciones al reducirse, y el token de
+    // lookahead no usa el arena, así que se puede generar y descartar.
+    if (state->emitStatement != NULL) {
+        state->emitStatement(state, &statement);
+    }
+    treeUtilsReset(state->tree);
+    return list;
+}
+
+Statement StatementGrammarAction(CompilerState *state, void *statement, StatementType type) {
     LogDebug("\tStatementGrammarAction for (%d)", type);
     return createStatement(type, statement);
 }
 
-IfStatement *IfStatementGrammarAction(Expression *cond, Block *if_block, Block *else_block) {
+IfStatement *IfStatementGrammarAction(CompilerState *state, Expression *cond, Block *if_block, Block *else_block) {
     // Todo ver impresion de block2 en caso de NULL
     //    LogDebug("\tIfStatementGrammarAction(%d, %d, %d)", exp, block1, block2);
-    
-    if (getExpressionType(cond) != VAR_BOOL) {
-        LogError("Condition must be a boolean expression");
-        exit(1);
+
+    if (cond->dataType != VAR_BOOL) {
+        SemanticError(state, "Condition must be a boolean expression");
+        return NULL;
     }
 
     IfStatementType type = IF_ELSE_TYPE;
     if (else_block == NULL) {
         type = IF_TYPE;
     }
-    return createIfStatement(type, cond, if_block, else_block);
+    return Allocated(state, createIfStatement(state->tree, type, cond, if_block, else_block));
 }
 
-ForStatement *ForStatementGrammarAction(char *varname, RangeExpression *range, Block *block) {
+void ForIteratorGrammarAction(CompilerState *state, char *varname) {
+    LogDebug("\tForIteratorGrammarAction");
+
+    // El iterador solo es visible dentro del cuerpo del "for".
+    if (!symbolTableEnterScope(state->symbols)) {
+        OutOfMemoryError(state);
+        return;
+    }
+    SymbolId symbol = SymbolTableDeclareAux(state, varname, INT_DECLARATION, true);
+    if (symbol == NO_SYMBOL) {
+        return;
+    }
+    Symbol *iterator = symbolTableModify(state->symbols, symbol);
+    if (iterator == NULL) {
+        OutOfMemoryError(state);
+        return;
+    }
+    iterator->metadata.readOnly = true;
+}
+
+ForStatement *ForStatementGrammarAction(CompilerState *state, char *varname, RangeExpression *range, Block *block) {
     LogDebug("\tForStatementGrammarAction");
 
-    SymbolTableDeclareAux(varname, INT_DECLARATION, true);
+    // El iterador se resuelve antes de cerrar su scope.
+    SymbolId symbol = symbolTableLookup(state->symbols, varname);
+    if (!symbolTableExitScope(state->symbols)) {
+        OutOfMemoryError(state);
+        return NULL;
+    }
 
-    return createForStatement(varname, range, block);
+    return Allocated(state, createForStatement(state->tree, symbol, range, block));
 }
 
-WhileStatement *WhileStatementGrammarAction(Expression *cond, Block *block) {
+WhileStatement *WhileStatementGrammarAction(CompilerState *state, Expression *cond, Block *block) {
     LogDebug("\tWhileStatementGrammarAction");
 
-    if (getExpressionType(cond) != VAR_BOOL) {
-        LogError("Condition must be a boolean expression");
-        exit(1);
+    if (cond->dataType != VAR_BOOL) {
+        SemanticError(state, "Condition must be a boolean expression");
+        return NULL;
     }
 
-    return createWhileStatement(cond, block);
+    return Allocated(state, createWhileStatement(state->tree, cond, block));
 }
 
-FunctionCall *FunctionDeclarationGrammarAction(char *varname, Declaration *declaration, FunctionCallType callType) {
+FunctionCall *FunctionDeclarationGrammarAction(CompilerState *state, char *varname, Declaration *declaration, FunctionCallType callType) {
     LogDebug("\tFunctionDeclarationGrammarAction");
 
-    struct key key = {.varname = varname};
-    if (!symbolTableFind(&key, NULL)) {
-        LogError("Variable %s undeclared", varname);
-        exit(1);
+    SymbolId symbol = SymbolTableFindAux(state, varname);
+    if (symbol == NO_SYMBOL) {
+        return NULL;
     }
 
-    if (declaration->type == INT_DECLARATION) {
-        LogError("Variable %s is an integer", declaration->varname);
-        exit(1);
+    if (declaration->type == VAR_INT) {
+        SemanticError(state, "Variable %s is an integer", symbolTableGet(state->symbols, declaration->symbol)->varname);
+        return NULL;
     }
 
-    return createFunctionCall(callType, varname, NULL, declaration);
+    return Allocated(state, createFunctionCall(state->tree, callType, symbol, NULL, declaration));
 }
 
-FunctionCall *FunctionGrammarAction(char *varname, Expression *exp, FunctionCallType type) {
+FunctionCall *FunctionGrammarAction(CompilerState *state, char *varname, Expression *exp, FunctionCallType type) {
     LogDebug("\tFunctionStatementGrammarAction of type (%d)", type);
-    struct key key = {.varname = varname};
-    if (!symbolTableFind(&key, NULL)) {
-        LogError("Variable %s undeclared", varname);
-        exit(1);
+    SymbolId symbol = SymbolTableFindAux(state, varname);
+    if (symbol == NO_SYMBOL) {
+        return NULL;
     }
 
-    return createFunctionCall(type, varname, exp, NULL);
+    return Allocated(state, createFunctionCall(state->tree, type, symbol, exp, NULL));
 }
 
-Assignment *AssignmentGrammarAction(char *var, Expression *exp, FunctionCall *functionCall) {
+Assignment *AssignmentGrammarAction(CompilerState *state, char *var, Expression *exp, FunctionCall *functionCall) {
     LogDebug("\tAssignmentGrammarAction");
 
-    struct key key = {.varname = var};
-    struct value value;
-    if (!symbolTableFind(&key, &value)) {
-        LogError("Variable %s undeclared", var);
-        exit(1);
+    SymbolId symbol = SymbolTableFindAux(state, var);
+    if (symbol == NO_SYMBOL) {
+        return NULL;
+    }
+    Symbol *value = symbolTableGet(state->symbols, symbol);
+
+    if (value->type != VAR_INT && value->type != VAR_BOOL) {
+        SemanticError(state, "Variable %s is not an integer nor a boolean", var);
+        return NULL;
     }
 
-    if (value.type != VAR_INT && value.type != VAR_BOOL) {
-        LogError("Variable %s is not an integer nor a boolean", var);
-        exit(1);
+    if (value->metadata.readOnly) {
+        SemanticError(state, "Variable %s is a loop iterator", var);
+        return NULL;
     }
 
-    if (functionCall != NULL && getFunctionCallType(functionCall) != value.type) {
-        LogError("Function return cannot be assigned to %s", var);
-        exit(1);
+    if (functionCall != NULL && getFunctionCallType(functionCall) != value->type) {
+        SemanticError(state, "Function return cannot be assigned to %s", var);
+        return NULL;
     }
 
-    if (exp != NULL && getExpressionType(exp) != value.type) {
-        LogError("Expression cannot be assigned to %s", var);
-        exit(1);
+    if (exp != NULL && exp->dataType != value->type) {
+        SemanticError(state, "Expression cannot be assigned to %s", var);
+        return NULL;
     }
 
-    value.metadata.hasValue = true;
-    symbolTableInsert(&key, &value);
+    if (!value->metadata.hasValue) {
+        value = symbolTableModify(state->symbols, symbol);
+        if (value == NULL) {
+            OutOfMemoryError(state);
+            return NULL;
+        }
+        value->metadata.hasValue = true;
+    }
 
-    return createAssignment(var, exp, functionCall);
+    return Allocated(state, createAssignment(state->tree, symbol, exp, functionCall));
 }
 
-RangeExpression *RangeExpressionGrammarAction(Expression *exp1, Expression *exp2) {
+RangeExpression *RangeExpressionGrammarAction(CompilerState *state, Expression *exp1, Expression *exp2) {
     LogDebug("\tRangeExpressionGrammarAction");
 
-    if ((exp1 != NULL && getExpressionType(exp1) != VAR_INT) || (exp2 && getExpressionType(exp2) != VAR_INT)) {
-        LogError("Parametros invalidos\n");
-        exit(1);
+    if ((exp1 != NULL && exp1->dataType != VAR_INT) || (exp2 && exp2->dataType != VAR_INT)) {
+        SemanticError(state, "Parametros invalidos\n");
+        return NULL;
     }
-    return createRangeExpression(exp1, exp2);
+    return Allocated(state, createRangeExpression(state->tree, exp1, exp2));
 }
 
-Expression *ExpressionGrammarAction(Expression *left, Expression *right, Factor *factor, ExpressionType type) {
+Expression *ExpressionGrammarAction(CompilerState *state, Expression *left, Expression *right, ExpressionType type) {
     LogDebug("\tExpressionGrammarAction of type (%d)", type);
-    
-    VarType leftType, rightType;
-    if (left != NULL && right != NULL && (leftType = getExpressionType(left)) != (rightType = getExpressionType(right))) {
-        LogError("Parametros invalidos\n");
-        exit(1);
+
+    if (left != NULL && right != NULL && left->dataType != right->dataType) {
+        SemanticError(state, "Parametros invalidos\n");
+        return NULL;
     }
 
     VarType expectedFactorType;
@@ -206,33 +316,47 @@ Expression *ExpressionGrammarAction(Expression *left, Expression *right, Factor
     } else {
         expectedFactorType = VAR_INT;
     }
-    
-    if (left != NULL && left->type == FACTOR_EXPRESSION && left->factor->type == VARIABLE_FACTOR) {
-        AddUsedSymbol(left->factor->varname, expectedFactorType);
+
+    if (left != NULL && left->type == FACTOR_EXPRESSION && left->factor.type == VARIABLE_FACTOR) {
+        AddUsedSymbol(state, left->factor.symbol, expectedFactorType);
     }
 
-    if (right != NULL && right->type == FACTOR_EXPRESSION && right->factor->type == VARIABLE_FACTOR) {
-        AddUsedSymbol(right->factor->varname, expectedFactorType);
+    if (right != NULL && right->type == FACTOR_EXPRESSION && right->factor.type == VARIABLE_FACTOR) {
+        AddUsedSymbol(state, right->factor.symbol, expectedFactorType);
     }
 
-    return createExpression(type, left, right, factor);
+    if (state->status != COMPILER_OK) {
+        return NULL;
+    }
+
+    return Allocated(state, createExpression(state->tree, type, InferExpressionType(type, left, right), left, right));
+}
+
+Expression *FactorExpressionGrammarAction(CompilerState *state, Factor factor) {
+    LogDebug("\tFactorExpressionGrammarAction of type (%d)", factor.type);
+    return Allocated(state, createFactorExpression(state->tree, InferFactorType(state, &factor), factor));
 }
 
-Factor *FactorGrammarAction(Expression *exp, Constant *con, char *varname, FactorType type) {
+Factor FactorGrammarAction(CompilerState *state, Expression *exp, Constant con, char *varname, FactorType type) {
     LogDebug("\tFactorGrammarAction of type (%d)", type);
 
-    
-    return createFactor(type, exp, con, varname);
+    SymbolId symbol = NO_SYMBOL;
+    if (type == VARIABLE_FACTOR) {
+        // Solo se ven las declaraciones anteriores, de este scope o de los
+        // que lo contienen.
+        symbol = SymbolTableFindAux(state, varname);
+    }
+
+    return createFactor(type, exp, con, symbol);
 }
 
-Constant *ConstantGrammarAction(int intValue, bool boolValue, ConstantType type) {
+Constant ConstantGrammarAction(CompilerState *state, int intValue, bool boolValue, ConstantType type) {
     LogDebug("\tConstantGrammarAction");
     return createConstant(intValue, boolValue, type);
 }
 
-static inline VarType SymbolTableDeclareAux(char *varname, DeclarationType type, bool hasValue) {
+static inline SymbolId SymbolTableDeclareAux(CompilerState *state, char *varname, DeclarationType type, bool hasValue) {
     VarType varType;
-    struct metadata metadata = {.hasValue = hasValue};
     switch (type) {
     case INT_DECLARATION:
         varType = VAR_INT;
@@ -253,163 +377,172 @@ static inline VarType SymbolTableDeclareAux(char *varname, DeclarationType type,
         assert(0 && "Illegal State");
         break;
     }
-    struct key key = {.varname = varname};
-    if (symbolTableFind(&key, NULL)) {
-        LogError("Redeclaration of var, %s", varname);
-        exit(1);
+    const uint64_t start = BeginCheck(state);
+    SymbolId symbol = NO_SYMBOL;
+    if (symbolTableLookup(state->symbols, varname) != NO_SYMBOL) {
+        SemanticError(state, "Redeclaration of var, %s", varname);
+    } else {
+        symbol = symbolTableDeclare(state->symbols, varname, varType, hasValue);
+        if (symbol == NO_SYMBOL) {
+            OutOfMemoryError(state);
+        }
     }
-    struct value value = {.type = varType, .metadata = metadata};
-    symbolTableInsert(&key, &value);
-    return varType;
+    EndCheck(state, start);
+    return symbol;
 }
 
-Declaration *DeclarationGrammarAction(char *varname, DeclarationType type) {
+static SymbolId SymbolTableFindAux(CompilerState *state, char *varname) {
+    const uint64_t start = BeginCheck(state);
+    SymbolId symbol = symbolTableLookup(state->symbols, varname);
+    if (symbol == NO_SYMBOL) {
+        SemanticError(state, "Variable %s undeclared", varname);
+    }
+    EndCheck(state, start);
+    return symbol;
+}
+
+Declaration *DeclarationGrammarAction(CompilerState *state, char *varname, DeclarationType type) {
     LogDebug("\tDeclarationGrammarAction");
-    VarType varType = SymbolTableDeclareAux(varname, type, false);
-    return createDeclaration(varType, varname, NULL);
+    SymbolId symbol = SymbolTableDeclareAux(state, varname, type, false);
+    if (symbol == NO_SYMBOL) {
+        return NULL;
+    }
+    return Allocated(state, createDeclaration(state->tree, symbolTableGet(state->symbols, symbol)->type, symbol, NULL));
 }
 
-Declaration *IntDeclarationAndAssignmentGrammarAction(char *varname, Expression *exp, FunctionCall *functionCall) {
+Declaration *IntDeclarationAndAssignmentGrammarAction(CompilerState *state, char *varname, Expression *exp, FunctionCall *functionCall) {
     LogDebug("\tIntDeclarationAndAssignmentGrammarAction");
-    VarType varType = SymbolTableDeclareAux(varname, INT_DECLARATION, true);
+    SymbolId symbol = SymbolTableDeclareAux(state, varname, INT_DECLARATION, true);
+    if (symbol == NO_SYMBOL) {
+        return NULL;
+    }
 
     if (functionCall != NULL && getFunctionCallType(functionCall) != VAR_INT) {
-        LogError("Function return cannot be assigned to %s", varname);
-        exit(1);
+        SemanticError(state, "Function return cannot be assigned to %s", varname);
+        return NULL;
     }
 
-    if (exp != NULL && getExpressionType(exp) != VAR_INT) {
-        LogError("Expression cannot be assigned to %s", varname);
-        exit(1);
+    if (exp != NULL && exp->dataType != VAR_INT) {
+        SemanticError(state, "Expression cannot be assigned to %s", varname);
+        return NULL;
     }
 
-    Assignment *assignment = createAssignment(varname, exp, functionCall);
-    return createDeclaration(varType, varname, assignment);
+    Assignment *assignment = Allocated(state, createAssignment(state->tree, symbol, exp, functionCall));
+    if (assignment == NULL) {
+        return NULL;
+    }
+    return Allocated(state, createDeclaration(state->tree, VAR_INT, symbol, assignment));
 }
 
-Declaration *BoolDeclarationAndAssignmentGrammarAction(char *varname, Expression *exp, FunctionCall *functionCall) {
+Declaration *BoolDeclarationAndAssignmentGrammarAction(CompilerState *state, char *varname, Expression *exp, FunctionCall *functionCall) {
     LogDebug("\tBoolDeclarationAndAssignmentGrammarAction");
-    VarType varType = SymbolTableDeclareAux(varname, BOOL_DECLARATION, true);
+    SymbolId symbol = SymbolTableDeclareAux(state, varname, BOOL_DECLARATION, true);
+    if (symbol == NO_SYMBOL) {
+        return NULL;
+    }
 
     if (functionCall != NULL && getFunctionCallType(functionCall) != VAR_BOOL) {
-        LogError("Function return cannot be assigned to %s", varname);
-        exit(1);
+        SemanticError(state, "Function return cannot be assigned to %s", varname);
+        return NULL;
     }
 
-    if (exp != NULL && getExpressionType(exp) != VAR_BOOL) {
-        LogError("Expression cannot be assigned to %s", varname);
-        exit(1);
+    if (exp != NULL && exp->dataType != VAR_BOOL) {
+        SemanticError(state, "Expression cannot be assigned to %s", varname);
+        return NULL;
     }
 
-    Assignment *assignment = createAssignment(varname, exp, functionCall);
-    return createDeclaration(varType, varname, assignment);
+    Assignment *assignment = Allocated(state, createAssignment(state->tree, symbol, exp, functionCall));
+    if (assignment == NULL) {
+        return NULL;
+    }
+    return Allocated(state, createDeclaration(state->tree, VAR_BOOL, symbol, assignment));
 }
 
-// Adds to the used symbols array
-static void AddUsedSymbol(char *varname, VarType expectedType) {
-    struct key key = {.varname = varname};
-
-    for (int i = 0; i < usedSymbolsCount; i++) {
-        if (strcmp(usedSymbols[i].varname, varname) == 0) {
-            if (usedSymbolsExpectedType[i] != expectedType) {
-                LogError("Variable %s conflicting types", varname);
-                exit(1);
-            }
-            return;
+// Records the use of a variable with the type its expression expects
+static void AddUsedSymbol(CompilerState *state, SymbolId symbol, VarType expectedType) {
+    Symbol *used = symbolTableGet(state->symbols, symbol);
+    LogDebug("\tAddUsedSymbol: %s", used->varname);
+
+    const uint64_t start = BeginCheck(state);
+    if (used->metadata.isUsed && used->metadata.expectedType != expectedType) {
+        SemanticError(state, "Variable %s conflicting types", used->varname);
+    } else if (!used->metadata.isUsed) {
+        used = symbolTableModify(state->symbols, symbol);
+        if (used == NULL) {
+            OutOfMemoryError(state);
+        } else {
+            used->metadata.isUsed = true;
+            used->metadata.expectedType = expectedType;
         }
     }
-
-    if (usedSymbolsCount == 0) {
-        usedSymbols = malloc(sizeof(struct key));
-        usedSymbolsExpectedType = malloc(sizeof(VarType));
-    } else if (usedSymbolsCount % 10 == 0) {
-        usedSymbols = realloc(usedSymbols, sizeof(struct key) * (usedSymbolsCount + 10));
-        usedSymbolsExpectedType = realloc(usedSymbolsExpectedType, sizeof(VarType) * (usedSymbolsCount + 10));
-    }
-
-    printf("Adding %s\n", varname);
-
-    usedSymbols[usedSymbolsCount] = key;
-    usedSymbolsExpectedType[usedSymbolsCount++] = expectedType;
-
-    printf("Added %s\n", usedSymbols[usedSymbolsCount - 1].varname);
+    EndCheck(state, start);
 }
 
-// Validates that all the symbols used in the program are declared
-// and have a value
-static void ValidateUsedSymbols() {
-    for (int i = 0; i < usedSymbolsCount; i++) {
-        struct key key = usedSymbols[i];
-        struct value value;
-        if (!symbolTableFind(&key, &value)) {
-            LogError("Variable %s undeclared", key.varname);
-            exit(1);
+// Validates that all the symbols used in the program have a value, in a
+// single pass over the symbol slots (undeclared uses fail when reduced)
+static void ValidateUsedSymbols(CompilerState *state) {
+    const SymbolId count = symbolTableSize(state->symbols);
+    for (SymbolId symbol = 0; symbol < count; symbol++) {
+        Symbol *used = symbolTableGet(state->symbols, symbol);
+        if (!used->metadata.isUsed) {
+            continue;
         }
 
-        if (value.metadata.hasValue == false) {
-            LogError("Variable %s has no value", key.varname);
-            exit(1);
+        if (used->metadata.hasValue == false) {
+            SemanticError(state, "Variable %s has no value", used->varname);
+            return;
         }
 
-        if (value.type != usedSymbolsExpectedType[i]) {
-            LogError("Variable %s is not of type %d", key.varname, usedSymbolsExpectedType[i]);
-            exit(1);
+        if (used->type != used->metadata.expectedType) {
+            SemanticError(state, "Variable %s is not of type %d", used->varname, used->metadata.expectedType);
+            return;
         }
     }
 }
 
-static int getExpressionType(Expression *expression) {
-    struct key key;
-    struct value value;
-    switch (expression->type) {
+// Infers the type of a new expression from the types already cached in its
+// children, so it runs in constant time
+static VarType InferExpressionType(ExpressionType type, Expression *left, Expression *right) {
+    switch (type) {
     case ADDITION_EXPRESSION:
     case SUBTRACTION_EXPRESSION:
     case MULTIPLICATION_EXPRESSION:
     case DIVISION_EXPRESSION:
     case MODULUS_EXPRESSION:
-        return (getExpressionType(expression->leftExpression) == VAR_INT && getExpressionType(expression->rightExpression) == VAR_INT)
-                   ? VAR_INT
-                   : -1;
+        return (left->dataType == VAR_INT && right->dataType == VAR_INT) ? VAR_INT : VAR_INVALID;
     case AND_EXPRESSION:
     case OR_EXPRESSION:
-        return (getExpressionType(expression->leftExpression) == VAR_BOOL && getExpressionType(expression->rightExpression) == VAR_BOOL)
-                   ? VAR_BOOL
-                   : -1;
+        return (left->dataType == VAR_BOOL && right->dataType == VAR_BOOL) ? VAR_BOOL : VAR_INVALID;
     case NOT_EXPRESSION:
-        return getExpressionType(expression->leftExpression) == VAR_BOOL ? VAR_BOOL : -1;
+        return left->dataType == VAR_BOOL ? VAR_BOOL : VAR_INVALID;
     case EQUALS_EXPRESSION:
     case NOT_EQUALS_EXPRESSION:
     case LESS_THAN_EXPRESSION:
     case LEES_EQUAL_EXPRESSION:
     case GREATER_THAN_EXPRESSION:
     case GREATER_EQUAL_EXPRESSION:
-        return (getExpressionType(expression->leftExpression) == getExpressionType(expression->rightExpression))
-                   ? VAR_BOOL
-                   : -1;
-    case FACTOR_EXPRESSION:
-        switch (expression->factor->type) {
-        case CONSTANT_FACTOR:
-            return expression->factor->constant->type == INT_CONSTANT ? VAR_INT : VAR_BOOL;
-        case EXPRESSION_FACTOR:
-            return getExpressionType(expression->factor->expression);
-        case VARIABLE_FACTOR:
-            key.varname = expression->factor->varname;
-            if (!symbolTableFind(&key, &value)) {
-                // It is a for loop iterator
-                return VAR_INT;
-            }
-            return value.type;
-        default:
-            LogError("Invalid factor type");
-            exit(1);
-        }
+        return (left->dataType == right->dataType) ? VAR_BOOL : VAR_INVALID;
+    default:
+        return VAR_INVALID;
+    }
+}
+
+static VarType InferFactorType(CompilerState *state, const Factor *factor) {
+    Symbol *symbol;
+    switch (factor->type) {
+    case CONSTANT_FACTOR:
+        return factor->constant.type == INT_CONSTANT ? VAR_INT : VAR_BOOL;
+    case EXPRESSION_FACTOR:
+        return factor->expression->dataType;
+    case VARIABLE_FACTOR:
+        symbol = symbolTableGet(state->symbols, factor->symbol);
+        return symbol->type;
     default:
-        LogError("Invalid expression type");
-        exit(1);
+        return VAR_INVALID;
     }
 }
 
-static int getFunctionCallType(FunctionCall *functionCall) {
+static VarType getFunctionCallType(FunctionCall *functionCall) {
     switch (functionCall->type) {
     case MAX_CALL:
     case MIN_CALL:
@@ -418,6 +551,6 @@ static int getFunctionCallType(FunctionCall *functionCall) {
     case PRESENT_CALL:
         return VAR_BOOL;
     default:
-        return -1;
+        return VAR_INVALID;
     }
 }
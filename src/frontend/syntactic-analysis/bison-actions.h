@@ -9,46 +9,62 @@
  * gramática. El objetivo de cada acción debe ser el de construir el nodo
  * adecuado que almacene la información requerida en el árbol de sintaxis
  * abstracta (i.e., el AST).
+ *
+ * Todas reciben el estado de la compilación en curso. Si una validación
+ * falla, la acción lo registra con "SemanticError" y devuelve NULL; la
+ * gramática aborta el análisis al ver el error.
  */
 
+// Registra un error semántico (solo se conserva el primero).
+void SemanticError(CompilerState * state, const char * format, ...);
+
+// Registra que no hubo memoria para continuar el análisis.
+void OutOfMemoryError(CompilerState * state);
+
+// Errores de sintaxis, invocada por Bison.
+void yyerror(CompilerState * state, void * scanner, const char * string);
+
 // Programa.
-Program * ProgramGrammarAction(StatementList statements);
+Program * ProgramGrammarAction(CompilerState * state, StatementList statements);
 
 // Block
-Block * BlockGrammarAction(StatementList statements);
+// Abre el scope del bloque, antes de reducir sus sentencias.
+void BeginBlockGrammarAction(CompilerState * state);
+Block * BlockGrammarAction(CompilerState * state, StatementList statements);
 
 //Statements
-StatementList StatementListGrammarAction(Statement * statement, StatementList next);
+StatementSequence StatementListGrammarAction(CompilerState * state, StatementSequence list, Statement statement);
+StatementSequence TopLevelStatementGrammarAction(CompilerState * state, StatementSequence list, Statement statement, size_t end, size_t read);
 
 // Statement
 // recibe void puntero asi puedo obtener cualquier tipo de statement
 // recibo el type para distinguir
-Statement * StatementGrammarAction(void * statement, StatementType type);
+Statement StatementGrammarAction(CompilerState * state, void * statement, StatementType type);
 
-IfStatement * IfStatementGrammarAction(Expression * cond, Block * if_block, Block * else_block);
-ForStatement * ForStatementGrammarAction(char * varname, RangeExpression * range, Block * block);
-WhileStatement * WhileStatementGrammarAction(Expression * expression, Block * block);
+IfStatement * IfStatementGrammarAction(CompilerState * state, Expression * cond, Block * if_block, Block * else_block);
+// Abre el scope del iterador, antes de reducir el cuerpo del "for".
+void ForIteratorGrammarAction(CompilerState * state, char * varname);
+ForStatement * ForStatementGrammarAction(CompilerState * state, char * varname, RangeExpression * range, Block * block);
+WhileStatement * WhileStatementGrammarAction(CompilerState * state, Expression * expression, Block * block);
 
 // Expresión.
-Expression * ExpressionGrammarAction(Expression * left, Expression * right, Factor * factor, ExpressionType type);
-RangeExpression * RangeExpressionGrammarAction(Expression * exp1, Expression * exp2);
+Expression * ExpressionGrammarAction(CompilerState * state, Expression * left, Expression * right, ExpressionType type);
+Expression * FactorExpressionGrammarAction(CompilerState * state, Factor factor);
+RangeExpression * RangeExpressionGrammarAction(CompilerState * state, Expression * exp1, Expression * exp2);
 
 // Factores.
-Factor * FactorGrammarAction(Expression * exp, Constant * con, char * varname, FactorType type);
-Constant * ConstantGrammarAction(int intValue, bool boolValue, ConstantType type);
+Factor FactorGrammarAction(CompilerState * state, Expression * exp, Constant con, char * varname, FactorType type);
+Constant ConstantGrammarAction(CompilerState * state, int intValue, bool boolValue, ConstantType type);
 
 // Funciones
-FunctionCall * FunctionGrammarAction(char * varname, Expression * exp, FunctionCallType type);
-FunctionCall * FunctionDeclarationGrammarAction(char *varname, Declaration *declaration, FunctionCallType callType);
-
-// Constantes.
-int IntegerConstantGrammarAction(int value);
+FunctionCall * FunctionGrammarAction(CompilerState * state, char * varname, Expression * exp, FunctionCallType type);
+FunctionCall * FunctionDeclarationGrammarAction(CompilerState * state, char *varname, Declaration *declaration, FunctionCallType callType);
 
 // Declaraciones
-Declaration * DeclarationGrammarAction(char * varname, DeclarationType type);
-Declaration * IntDeclarationAndAssignmentGrammarAction(char * varname, Expression * exp, FunctionCall * functionCall);
-Declaration *BoolDeclarationAndAssignmentGrammarAction(char *varname, Expression *exp, FunctionCall *functionCall);
+Declaration * DeclarationGrammarAction(CompilerState * state, char * varname, DeclarationType type);
+Declaration * IntDeclarationAndAssignmentGrammarAction(CompilerState * state, char * varname, Expression * exp, FunctionCall * functionCall);
+Declaration *BoolDeclarationAndAssignmentGrammarAction(CompilerState * state, char *varname, Expression *exp, FunctionCall *functionCall);
 
-Assignment * AssignmentGrammarAction(char * var, Expression * exp, FunctionCall * functionCall);
+Assignment * AssignmentGrammarAction(CompilerState * state, char * var, Expression * exp, FunctionCall * functionCall);
 
 #endif
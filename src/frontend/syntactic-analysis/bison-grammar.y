@@ -1,15 +1,46 @@
+%code requires {
+#include "../../backend/support/shared.h"
+}
+
+%code provides {
+// El analizador léxico es reentrante: recibe dónde dejar el valor semántico
+// y la instancia de Flex a utilizar.
+int yylex(YYSTYPE * lvalp, void * scanner);
+}
+
 %{
 
 #include "bison-actions.h"
 
+// Ante un error semántico las acciones devuelven NULL y lo registran en el
+// estado; se aborta el análisis en lugar de seguir reduciendo.
+#define CHECKED(...) do { __VA_ARGS__; if (state->status != COMPILER_OK) YYABORT; } while (0)
+
+// La lista de sentencias es recursiva a izquierda y no hace crecer la pila,
+// pero las expresiones y bloques anidados sí. La pila de Bison vive en el
+// heap, así que se permite crecer bastante más que el valor por defecto.
+#define YYMAXDEPTH 10000000
+
+// Dónde termina la sentencia recién reducida, y hasta dónde se leyó el fuente
+// para reducirla: si Bison ya pidió el token siguiente, es el último lexema y
+// la sentencia termina donde éste empieza (ver "addStatement").
+#define STATEMENT_END (yychar == YYEOF ? SIZE_MAX : yychar == YYEMPTY ? ScannerLexemeEnd(scanner) : ScannerLexemeStart(scanner))
+#define STATEMENT_READ (yychar == YYEOF ? SIZE_MAX : ScannerLexemeEnd(scanner))
+
 %}
 
+// Analizador puro: no usa variables globales, así que varias compilaciones
+// pueden convivir en un mismo proceso.
+%define api.pure full
+%parse-param {CompilerState * state} {void * scanner}
+%lex-param {void * scanner}
+
 // Tipos de dato utilizados en las variables semánticas ($$, $1, $2, etc.).
 %union {
 	// No-terminales (backend).
     Program * program;
-    StatementList statement_list;
-    Statement * statement;
+    StatementSequence statement_list;
+    Statement statement;
     Assignment * assignment;
     FunctionCall * function_call;
     Declaration * declaration;
@@ -19,8 +50,8 @@
     IfStatement * if_statement;
     Block * block;
     Expression * expression;
-    Factor * factor;
-    Constant * constant;
+    Factor factor;
+    Constant constant;
 
     char * varname;
 
@@ -50,7 +81,7 @@
 // Tipos de dato para los no-terminales generados desde Bison.
 %type <program> program
 %type <block> block
-%type <statement_list> statement_list
+%type <statement_list> top_level_list statement_list
 %type <statement> statement
 %type <if_statement> if_statement
 %type <for_statement> for_statement
@@ -78,92 +109,100 @@
 
 %%
 
-program: statement_list[st_list]                                                         { $$ = ProgramGrammarAction($st_list); }
+program: top_level_list[st_list]                                                         { CHECKED($$ = ProgramGrammarAction(state, $st_list.first)); }
        ;
 
+// Igual que "statement_list", pero en modo "streaming" cada sentencia se genera
+// y se libera al reducirse.
+top_level_list: top_level_list[list] statement[st]                                       { CHECKED($$ = TopLevelStatementGrammarAction(state, $list, $st, STATEMENT_END, STATEMENT_READ)); }
+              | statement[st]                                                            { CHECKED($$ = TopLevelStatementGrammarAction(state, (StatementSequence) {NULL, NULL}, $st, STATEMENT_END, STATEMENT_READ)); }
+              ;
+
 
-block: OPEN_CURL_BRACKETS statement_list[st_list] CLOSE_CURL_BRACKETS                    { $$ = BlockGrammarAction($st_list); }
+block: OPEN_CURL_BRACKETS                                                                { CHECKED(BeginBlockGrammarAction(state)); }
+       statement_list[st_list] CLOSE_CURL_BRACKETS                                       { CHECKED($$ = BlockGrammarAction(state, $st_list.first)); }
      ;
 
-statement_list: statement[st] statement_list[next]                                       { $$ = StatementListGrammarAction($st, $next); }
-              | statement[st]                                                            { $$ = StatementListGrammarAction($st, NULL); }
+statement_list: statement_list[list] statement[st]                                       { CHECKED($$ = StatementListGrammarAction(state, $list, $st)); }
+              | statement[st]                                                            { CHECKED($$ = StatementListGrammarAction(state, (StatementSequence) {NULL, NULL}, $st)); }
               ;
 
-statement: if_statement[st]                                                              { $$ = StatementGrammarAction($st, IF_STATEMENT); }
-         | for_statement[st]                                                             { $$ = StatementGrammarAction($st, FOR_STATEMENT); }
-         | while_statement[st]                                                           { $$ = StatementGrammarAction($st, WHILE_STATEMENT); }
-         | function_call[st] SEMI_COLON                                                  { $$ = StatementGrammarAction($st, FUNCTION_CALL_STATEMENT); }
-         | declaration[st] SEMI_COLON                                                    { $$ = StatementGrammarAction($st, DECLARATION_STATEMENT); }
-         | assignment[st] SEMI_COLON                                                     { $$ = StatementGrammarAction($st, ASSIGNMENT_STATEMENT); }
+statement: if_statement[st]                                                              { CHECKED($$ = StatementGrammarAction(state, $st, IF_STATEMENT)); }
+         | for_statement[st]                                                             { CHECKED($$ = StatementGrammarAction(state, $st, FOR_STATEMENT)); }
+         | while_statement[st]                                                           { CHECKED($$ = StatementGrammarAction(state, $st, WHILE_STATEMENT)); }
+         | function_call[st] SEMI_COLON                                                  { CHECKED($$ = StatementGrammarAction(state, $st, FUNCTION_CALL_STATEMENT)); }
+         | declaration[st] SEMI_COLON                                                    { CHECKED($$ = StatementGrammarAction(state, $st, DECLARATION_STATEMENT)); }
+         | assignment[st] SEMI_COLON                                                     { CHECKED($$ = StatementGrammarAction(state, $st, ASSIGNMENT_STATEMENT)); }
          ;
 
-if_statement: IF OPEN_PARENTHESIS expression[cond] CLOSE_PARENTHESIS block[if_block] ELSE block[else_block] { $$ = IfStatementGrammarAction($cond, $if_block, $else_block); }
-            | IF OPEN_PARENTHESIS expression[cond] CLOSE_PARENTHESIS block[if_block]                        { $$ = IfStatementGrammarAction($cond, $if_block, NULL); }
+if_statement: IF OPEN_PARENTHESIS expression[cond] CLOSE_PARENTHESIS block[if_block] ELSE block[else_block] { CHECKED($$ = IfStatementGrammarAction(state, $cond, $if_block, $else_block)); }
+            | IF OPEN_PARENTHESIS expression[cond] CLOSE_PARENTHESIS block[if_block]                        { CHECKED($$ = IfStatementGrammarAction(state, $cond, $if_block, NULL)); }
             ;
 
-for_statement: FOR VARIABLE[var] IN range_expression[range] block                        { $$ = ForStatementGrammarAction($var, $range, $block); }
+for_statement: FOR VARIABLE[var] IN range_expression[range]                              { CHECKED(ForIteratorGrammarAction(state, $var)); }
+               block                                                                     { CHECKED($$ = ForStatementGrammarAction(state, $var, $range, $block)); }
              ;
 
-while_statement: WHILE OPEN_PARENTHESIS expression[cond] CLOSE_PARENTHESIS block         { $$ = WhileStatementGrammarAction($cond, $block); }
+while_statement: WHILE OPEN_PARENTHESIS expression[cond] CLOSE_PARENTHESIS block         { CHECKED($$ = WhileStatementGrammarAction(state, $cond, $block)); }
                ;
 
-function_call: PRINT VARIABLE[var]                                                       { $$ = FunctionGrammarAction($var, NULL, PRINT_CALL); }
-	         | MAX VARIABLE[var]                                                         { $$ = FunctionGrammarAction($var, NULL, MAX_CALL); }
-	         | MIN VARIABLE[var]                                                         { $$ = FunctionGrammarAction($var, NULL, MIN_CALL); }
-	         | ROOT VARIABLE[var]                                                        { $$ = FunctionGrammarAction($var, NULL, ROOT_CALL); }
-	         | HEIGHT VARIABLE[var]                                                      { $$ = FunctionGrammarAction($var, NULL, HEIGHT_CALL); }
-             | INSERT VARIABLE[var] expression[exp]                                      { $$ = FunctionGrammarAction($var, $exp, INSERT_CALL); }
-             | REMOVE VARIABLE[var] expression[exp]                                      { $$ = FunctionGrammarAction($var, $exp, REMOVE_CALL); }
-             | INORDER VARIABLE[var]                                                     { $$ = FunctionGrammarAction($var, NULL, INORDER_CALL); }
-             | POSTORDER VARIABLE[var]                                                   { $$ = FunctionGrammarAction($var, NULL, POSTORDER_CALL); }
-             | PREORDER VARIABLE[var]                                                    { $$ = FunctionGrammarAction($var, NULL, PREORDER_CALL); }
-             | REDUCE EVEN VARIABLE[var]                                                 { $$ = FunctionGrammarAction($var, NULL, REDUCE_EVEN_CALL); }
-             | REDUCE ODD VARIABLE[var]                                                  { $$ = FunctionGrammarAction($var, NULL, REDUCE_ODD_CALL); }
-             | FIND VARIABLE[var] expression[exp]                                        { $$ = FunctionGrammarAction($var, $exp, FIND_CALL); }
-             | PRESENT expression[exp] VARIABLE[var]                                     { $$ = FunctionGrammarAction($var, $exp, PRESENT_CALL); }
-             | declaration[decl] ADD_TREE VARIABLE[var]                                  { $$ = FunctionDeclarationGrammarAction($var, $decl, ADD_TREE_CALL); } 
+function_call: PRINT VARIABLE[var]                                                       { CHECKED($$ = FunctionGrammarAction(state, $var, NULL, PRINT_CALL)); }
+	         | MAX VARIABLE[var]                                                         { CHECKED($$ = FunctionGrammarAction(state, $var, NULL, MAX_CALL)); }
+	         | MIN VARIABLE[var]                                                         { CHECKED($$ = FunctionGrammarAction(state, $var, NULL, MIN_CALL)); }
+	         | ROOT VARIABLE[var]                                                        { CHECKED($$ = FunctionGrammarAction(state, $var, NULL, ROOT_CALL)); }
+	         | HEIGHT VARIABLE[var]                                                      { CHECKED($$ = FunctionGrammarAction(state, $var, NULL, HEIGHT_CALL)); }
+             | INSERT VARIABLE[var] expression[exp]                                      { CHECKED($$ = FunctionGrammarAction(state, $var, $exp, INSERT_CALL)); }
+             | REMOVE VARIABLE[var] expression[exp]                                      { CHECKED($$ = FunctionGrammarAction(state, $var, $exp, REMOVE_CALL)); }
+             | INORDER VARIABLE[var]                                                     { CHECKED($$ = FunctionGrammarAction(state, $var, NULL, INORDER_CALL)); }
+             | POSTORDER VARIABLE[var]                                                   { CHECKED($$ = FunctionGrammarAction(state, $var, NULL, POSTORDER_CALL)); }
+             | PREORDER VARIABLE[var]                                                    { CHECKED($$ = FunctionGrammarAction(state, $var, NULL, PREORDER_CALL)); }
+             | REDUCE EVEN VARIABLE[var]                                                 { CHECKED($$ = FunctionGrammarAction(state, $var, NULL, REDUCE_EVEN_CALL)); }
+             | REDUCE ODD VARIABLE[var]                                                  { CHECKED($$ = FunctionGrammarAction(state, $var, NULL, REDUCE_ODD_CALL)); }
+             | FIND VARIABLE[var] expression[exp]                                        { CHECKED($$ = FunctionGrammarAction(state, $var, $exp, FIND_CALL)); }
+             | PRESENT expression[exp] VARIABLE[var]                                     { CHECKED($$ = FunctionGrammarAction(state, $var, $exp, PRESENT_CALL)); }
+             | declaration[decl] ADD_TREE VARIABLE[var]                                  { CHECKED($$ = FunctionDeclarationGrammarAction(state, $var, $decl, ADD_TREE_CALL)); } 
              ;
 // CHECK: mover el add_tree aca???
-declaration: NEW_TREE BST VARIABLE[var]                                                  { $$ = DeclarationGrammarAction($var, BST_DECLARATION); }
-           | NEW_TREE AVL VARIABLE[var]                                                  { $$ = DeclarationGrammarAction($var, AVL_DECLARATION); }
-           | NEW_TREE RBT VARIABLE[var]                                                  { $$ = DeclarationGrammarAction($var, RBT_DECLARATION); }
-           | INT VARIABLE[var]                                                           { $$ = DeclarationGrammarAction($var, INT_DECLARATION); }
-           | BOOL VARIABLE[var]                                                          { $$ = DeclarationGrammarAction($var, BOOL_DECLARATION); }
-           | INT VARIABLE[var] ASSIGN expression[exp]                                    { $$ = IntDeclarationAndAssignmentGrammarAction($var, $exp, NULL); }
-           | INT VARIABLE[var] ASSIGN function_call[call]                                { $$ = IntDeclarationAndAssignmentGrammarAction($var, NULL, $call); }
-           | BOOL VARIABLE[var] ASSIGN expression[exp]                                   { $$ = BoolDeclarationAndAssignmentGrammarAction($var, $exp, NULL); }
-           | BOOL VARIABLE[var] ASSIGN function_call[call]                               { $$ = BoolDeclarationAndAssignmentGrammarAction($var, NULL, $call); }
+declaration: NEW_TREE BST VARIABLE[var]                                                  { CHECKED($$ = DeclarationGrammarAction(state, $var, BST_DECLARATION)); }
+           | NEW_TREE AVL VARIABLE[var]                                                  { CHECKED($$ = DeclarationGrammarAction(state, $var, AVL_DECLARATION)); }
+           | NEW_TREE RBT VARIABLE[var]                                                  { CHECKED($$ = DeclarationGrammarAction(state, $var, RBT_DECLARATION)); }
+           | INT VARIABLE[var]                                                           { CHECKED($$ = DeclarationGrammarAction(state, $var, INT_DECLARATION)); }
+           | BOOL VARIABLE[var]                                                          { CHECKED($$ = DeclarationGrammarAction(state, $var, BOOL_DECLARATION)); }
+           | INT VARIABLE[var] ASSIGN expression[exp]                                    { CHECKED($$ = IntDeclarationAndAssignmentGrammarAction(state, $var, $exp, NULL)); }
+           | INT VARIABLE[var] ASSIGN function_call[call]                                { CHECKED($$ = IntDeclarationAndAssignmentGrammarAction(state, $var, NULL, $call)); }
+           | BOOL VARIABLE[var] ASSIGN expression[exp]                                   { CHECKED($$ = BoolDeclarationAndAssignmentGrammarAction(state, $var, $exp, NULL)); }
+           | BOOL VARIABLE[var] ASSIGN function_call[call]                               { CHECKED($$ = BoolDeclarationAndAssignmentGrammarAction(state, $var, NULL, $call)); }
            ;
 
-assignment: VARIABLE[var] ASSIGN expression[exp]                                         { $$ = AssignmentGrammarAction($var, $exp, NULL); }
-          | VARIABLE[var] ASSIGN function_call[call]                                     { $$ = AssignmentGrammarAction($var, NULL, $call); }
+assignment: VARIABLE[var] ASSIGN expression[exp]                                         { CHECKED($$ = AssignmentGrammarAction(state, $var, $exp, NULL)); }
+          | VARIABLE[var] ASSIGN function_call[call]                                     { CHECKED($$ = AssignmentGrammarAction(state, $var, NULL, $call)); }
           ;
 
-expression: expression[left] ADD expression[right]                                       { $$ = ExpressionGrammarAction($left, $right, NULL,    ADDITION_EXPRESSION); }
-          | expression[left] SUB expression[right]                                       { $$ = ExpressionGrammarAction($left, $right, NULL,    SUBTRACTION_EXPRESSION); }
-          | expression[left] MUL expression[right]                                       { $$ = ExpressionGrammarAction($left, $right, NULL,    MULTIPLICATION_EXPRESSION); }
-          | expression[left] DIV expression[right]                                       { $$ = ExpressionGrammarAction($left, $right, NULL,    DIVISION_EXPRESSION); }
-          | expression[left] MOD expression[right]                                       { $$ = ExpressionGrammarAction($left, $right, NULL,    MODULUS_EXPRESSION); }
-          | expression[left] AND expression[right]                                       { $$ = ExpressionGrammarAction($left, $right, NULL,    AND_EXPRESSION); }
-          | NOT expression[exp]                                                          { $$ = ExpressionGrammarAction($exp,  NULL,   NULL,    NOT_EXPRESSION); }
-          | expression[left] OR expression[right]                                        { $$ = ExpressionGrammarAction($left, $right, NULL,    OR_EXPRESSION); }
-          | expression[left] EQ expression[right]                                        { $$ = ExpressionGrammarAction($left, $right, NULL,    EQUALS_EXPRESSION); }
-          | expression[left] NE expression[right]                                        { $$ = ExpressionGrammarAction($left, $right, NULL,    NOT_EQUALS_EXPRESSION); }
-          | expression[left] LT expression[right]                                        { $$ = ExpressionGrammarAction($left, $right, NULL,    LESS_THAN_EXPRESSION); }
-          | expression[left] LE expression[right]                                        { $$ = ExpressionGrammarAction($left, $right, NULL,    LEES_EQUAL_EXPRESSION); }
-          | expression[left] GT expression[right]                                        { $$ = ExpressionGrammarAction($left, $right, NULL,    GREATER_THAN_EXPRESSION); }
-          | expression[left] GE expression[right]                                        { $$ = ExpressionGrammarAction($left, $right, NULL,    GREATER_EQUAL_EXPRESSION); }
-          | factor                                                                       { $$ = ExpressionGrammarAction(NULL,  NULL,   $factor, FACTOR_EXPRESSION); }
+expression: expression[left] ADD expression[right]                                       { CHECKED($$ = ExpressionGrammarAction(state, $left, $right, ADDITION_EXPRESSION)); }
+          | expression[left] SUB expression[right]                                       { CHECKED($$ = ExpressionGrammarAction(state, $left, $right, SUBTRACTION_EXPRESSION)); }
+          | expression[left] MUL expression[right]                                       { CHECKED($$ = ExpressionGrammarAction(state, $left, $right, MULTIPLICATION_EXPRESSION)); }
+          | expression[left] DIV expression[right]                                       { CHECKED($$ = ExpressionGrammarAction(state, $left, $right, DIVISION_EXPRESSION)); }
+          | expression[left] MOD expression[right]                                       { CHECKED($$ = ExpressionGrammarAction(state, $left, $right, MODULUS_EXPRESSION)); }
+          | expression[left] AND expression[right]                                       { CHECKED($$ = ExpressionGrammarAction(state, $left, $right, AND_EXPRESSION)); }
+          | NOT expression[exp]                                                          { CHECKED($$ = ExpressionGrammarAction(state, $exp,  NULL,   NOT_EXPRESSION)); }
+          | expression[left] OR expression[right]                                        { CHECKED($$ = ExpressionGrammarAction(state, $left, $right, OR_EXPRESSION)); }
+          | expression[left] EQ expression[right]                                        { CHECKED($$ = ExpressionGrammarAction(state, $left, $right, EQUALS_EXPRESSION)); }
+          | expression[left] NE expression[right]                                        { CHECKED($$ = ExpressionGrammarAction(state, $left, $right, NOT_EQUALS_EXPRESSION)); }
+          | expression[left] LT expression[right]                                        { CHECKED($$ = ExpressionGrammarAction(state, $left, $right, LESS_THAN_EXPRESSION)); }
+          | expression[left] LE expression[right]                                        { CHECKED($$ = ExpressionGrammarAction(state, $left, $right, LEES_EQUAL_EXPRESSION)); }
+          | expression[left] GT expression[right]                                        { CHECKED($$ = ExpressionGrammarAction(state, $left, $right, GREATER_THAN_EXPRESSION)); }
+          | expression[left] GE expression[right]                                        { CHECKED($$ = ExpressionGrammarAction(state, $left, $right, GREATER_EQUAL_EXPRESSION)); }
+          | factor                                                                       { CHECKED($$ = FactorExpressionGrammarAction(state, $factor)); }
           ;
 
-range_expression: OPEN_PARENTHESIS expression[left] COMMA expression[right] CLOSE_PARENTHESIS { $$ = RangeExpressionGrammarAction($left, $right); }
+range_expression: OPEN_PARENTHESIS expression[left] COMMA expression[right] CLOSE_PARENTHESIS { CHECKED($$ = RangeExpressionGrammarAction(state, $left, $right)); }
 
-factor: OPEN_PARENTHESIS expression[exp] CLOSE_PARENTHESIS                               { $$ = FactorGrammarAction($exp, NULL, NULL, EXPRESSION_FACTOR); }
-      | constant[con]                                                                    { $$ = FactorGrammarAction(NULL, $con, NULL, CONSTANT_FACTOR); }
-      | VARIABLE[var]                                                                    { $$ = FactorGrammarAction(NULL, NULL, $var, VARIABLE_FACTOR); }
+factor: OPEN_PARENTHESIS expression[exp] CLOSE_PARENTHESIS                               { CHECKED($$ = FactorGrammarAction(state, $exp, (Constant) {0}, NULL, EXPRESSION_FACTOR)); }
+      | constant[con]                                                                    { CHECKED($$ = FactorGrammarAction(state, NULL, $con, NULL, CONSTANT_FACTOR)); }
+      | VARIABLE[var]                                                                    { CHECKED($$ = FactorGrammarAction(state, NULL, (Constant) {0}, $var, VARIABLE_FACTOR)); }
       ;
 
-constant: INTEGER[integer]                                                               { $$ = ConstantGrammarAction($integer, false, INT_CONSTANT); }
-        | BOOLEAN[boolean]                                                               { $$ = ConstantGrammarAction(-1, $boolean, BOOL_CONSTANT); }
+constant: INTEGER[integer]                                                               { CHECKED($$ = ConstantGrammarAction(state, $integer, false, INT_CONSTANT)); }
+        | BOOLEAN[boolean]                                                               { CHECKED($$ = ConstantGrammarAction(state, -1, $boolean, BOOL_CONSTANT)); }
         ;
 %%
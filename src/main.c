@@ -1,20 +1,287 @@
+#include "batch.h"
+#include "compiler.h"
+#include "server.h"
+#include "watch.h"
 #include "backend/code-generation/generator.h"
 #include "backend/support/logger.h"
-#include "backend/support/shared.h"
-#include "backend/semantic-analysis/tree-utils.h"
+#include "backend/support/mapped-file.h"
+#include "backend/support/perf-counters.h"
+#include "backend/support/trace.h"
 #include "frontend/syntactic-analysis/bison-parser.h"
-#include "backend/semantic-analysis/symbol-table.h"
+#include <errno.h>
+#include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
 
-// Estado de la aplicación.
-CompilerState state;
+#define MAVEN_MAIN_PATH "./src/backend/domain-specific/src/main/java/Main.java"
+
+// En modo "streaming" se vuelca el buffer cada vez que supera este tamaño.
+#define STREAM_FLUSH_SIZE (64 * 1024)
+
+// Salida del modo "streaming". Se escribe sobre un archivo temporal que se
+// renombra al destino recién cuando la compilación termina sin errores; si se
+// escribe a la salida estándar, lo emitido antes de un error ya salió.
+static struct {
+	outputBufferADT buffer;
+	FILE * file;
+	char * temporaryPath;
+	bool failed;
+} stream;
+
+// Estado de la compilación, y archivo de entrada si se indicó uno en lugar de
+// la entrada estándar.
+static CompilerState * state = NULL;
+static mappedFileADT input = NULL;
+
+// Con "--time-report", medición de las fases y archivo donde se informa.
+static traceADT trace = NULL;
+static const char * traceReportPath = NULL;
+
+// Con "--perf-counters", contadores de hardware de cada fase.
+static bool countersReport = false;
+static perfCountersADT counters = NULL;
+
+static void ReportPhase(const char * name, uint32_t depth, uint64_t nanoseconds, const PerfSample * sample, void * data) {
+    char columns[PERF_COUNTERS * 24 + 16];
+    int length = 0;
+    for (int counter = 0; counter < PERF_COUNTERS; ++counter) {
+        if (perfCountersAvailable(counters, counter)) {
+            length += snprintf(columns + length, sizeof(columns) - length, " %16" PRIu64, sample->values[counter]);
+        } else {
+            length += snprintf(columns + length, sizeof(columns) - length, " %16s", "-");
+        }
+    }
+    if (perfCountersAvailable(counters, PERF_CYCLES) && perfCountersAvailable(counters, PERF_INSTRUCTIONS) && sample->values[PERF_CYCLES] > 0) {
+        snprintf(columns + length, sizeof(columns) - length, " %6.2f", (double) sample->values[PERF_INSTRUCTIONS] / sample->values[PERF_CYCLES]);
+    }
+    LogInfo("%*s%-*s %10.3f%s", 2 * depth, "", 36 - 2 * depth, name, nanoseconds / 1e6, columns);
+}
+
+static void ReportCounters() {
+    char header[PERF_COUNTERS * 24 + 16];
+    int length = 0;
+    for (int counter = 0; counter < PERF_COUNTERS; ++counter) {
+        length += snprintf(header + length, sizeof(header) - length, " %16s", perfCounterName(counter));
+    }
+    LogInfo("%-36s %10s%s %6s", "Fase", "ms", header, "IPC");
+    traceVisit(trace, ReportPhase, NULL);
+}
+
+// Con "--perf-counters", el scanner se mide en una pasada aparte, sobre una
+// copia de la entrada y con su propio estado: dentro del análisis corre
+// intercalado con Bison, y leer los contadores en cada token alteraría lo que
+// se mide.
+static void ScanSeparately() {
+    CompilerState * scanState = compilerInit();
+    void * scanner = scanState == NULL ? NULL : ScannerInit(scanState);
+    if (scanner != NULL && ScannerSetString(scanner, mappedFileData(input), mappedFileSize(input))) {
+        YYSTYPE value;
+        traceBegin(trace, "Scanner (pasada aparte)");
+        while (yylex(&value, scanner) != 0) {
+        }
+        traceEnd(trace);
+    }
+    ScannerDestroy(scanner);
+    compilerDestroy(scanState);
+}
+
+// Con "--mem-stats", se informa el uso de memoria al terminar.
+static bool memoryReport = false;
+
+static void ReportHashMap(const char * name, const HashMapStats * stats) {
+    LogInfo("Tabla %s: %" PRIu64 " de %" PRIu64 " entradas (carga %.2f), %" PRIu64 " redimensiones, %" PRIu64
+        " borrados (%" PRIu64 " entradas desplazadas, sin tombstones), sondeo maximo %" PRIu64 ".",
+        name, stats->size, stats->capacity, (double) stats->size / stats->capacity, stats->resizes,
+        stats->removals, stats->shifted, stats->maxProbe);
+    char histogram[HASHMAP_PROBE_BUCKETS * 32];
+    int length = 0;
+    for (int i = 0; i < HASHMAP_PROBE_BUCKETS; ++i) {
+        length += snprintf(histogram + length, sizeof(histogram) - length, "%s%d%s: %" PRIu64,
+            i == 0 ? "" : ", ", i, i == HASHMAP_PROBE_BUCKETS - 1 ? "+" : "", stats->probes[i]);
+    }
+    LogInfo("\tEntradas por distancia a su posicion ideal: %s.", histogram);
+}
+
+static void ReportMemory() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        // En Linux, "ru_maxrss" está en KiB.
+        LogInfo("Memoria residente maxima: %.1f MiB.", usage.ru_maxrss / 1024.0);
+    }
+    if (state == NULL) {
+        return;
+    }
+    TreeStats tree;
+    treeUtilsStats(state->tree, &tree);
+    uint64_t nodes = 0;
+    uint64_t bytes = 0;
+    for (int type = 0; type < TREE_NODE_TYPES; ++type) {
+        nodes += tree.nodes[type];
+        bytes += tree.bytes[type];
+    }
+    LogInfo("AST: %" PRIu64 " nodos creados, %" PRIu64 " bytes%s. Arena: %" PRIu64 " bloques, %" PRIu64 " de %" PRIu64 " bytes en uso.",
+        nodes, bytes, state->cache != NULL ? " (el programa se cargo desde la cache)" : "",
+        tree.arena.blocks, tree.arena.used, tree.arena.reserved);
+    for (int type = 0; type < TREE_NODE_TYPES; ++type) {
+        if (tree.nodes[type] > 0) {
+            LogInfo("\t%-20s %12" PRIu64 " nodos %14" PRIu64 " bytes", treeUtilsNodeName(type), tree.nodes[type], tree.bytes[type]);
+        }
+    }
+    SymbolTableStats symbols;
+    symbolTableStats(state->symbols, &symbols);
+    LogInfo("Simbolos: %" PRIu32 " slots, %" PRIu64 " entradas en el log de scopes.", symbols.symbols, symbols.undoLogEntries);
+    ReportHashMap("de simbolos visibles", &symbols.visible);
+    HashMapStats names;
+    ArenaStats strings;
+    internerStats(state->interner, &names, &strings);
+    ReportHashMap("de identificadores", &names);
+    LogInfo("Identificadores: %" PRIu64 " de %" PRIu64 " bytes en uso.", strings.used, strings.reserved);
+}
+
+// Todas las salidas de una compilación pasan por acá: se informan las
+// mediciones pedidas.
+static void DestroyCompiler() {
+    if (memoryReport) {
+        ReportMemory();
+    }
+    if (trace != NULL) {
+        if (countersReport) {
+            ReportCounters();
+        }
+        if (traceReportPath != NULL) {
+            if (traceWrite(trace, traceReportPath)) {
+                LogInfo("Tiempos por fase en '%s'.", traceReportPath);
+            } else {
+                LogError("No se pudo escribir '%s'.", traceReportPath);
+            }
+        }
+        traceDestroy(trace);
+        trace = NULL;
+        perfCountersClose(counters);
+        counters = NULL;
+    }
+    mappedFileClose(input);
+    input = NULL;
+    compilerDestroy(state);
+    state = NULL;
+}
+
+static void StreamStatement(CompilerState * state, Statement * statement) {
+    Generator generator = {.output = stream.buffer, .symbols = state->symbols};
+    GeneratorStatement(&generator, statement);
+    stream.failed |= generator.failed;
+    if (outputBufferLength(stream.buffer) >= STREAM_FLUSH_SIZE) {
+        stream.failed |= !outputBufferFlushToFile(stream.buffer, stream.file);
+        outputBufferReset(stream.buffer);
+    }
+}
+
+static void DiscardStream() {
+    if (stream.temporaryPath != NULL) {
+        unlink(stream.temporaryPath);
+        free(stream.temporaryPath);
+        stream.temporaryPath = NULL;
+    }
+}
+
+static bool BeginStream(const char * outputPath) {
+    if (strcmp(outputPath, "-") == 0) {
+        stream.file = stdout;
+    } else {
+        stream.temporaryPath = malloc(strlen(outputPath) + sizeof(".tmp"));
+        if (stream.temporaryPath == NULL) {
+            LogError("No hay memoria disponible.");
+            return false;
+        }
+        sprintf(stream.temporaryPath, "%s.tmp", outputPath);
+        stream.file = fopen(stream.temporaryPath, "w");
+        if (stream.file == NULL) {
+            free(stream.temporaryPath);
+            stream.temporaryPath = NULL;
+            return false;
+        }
+    }
+    stream.buffer = outputBufferInit(STREAM_FLUSH_SIZE);
+    if (stream.buffer == NULL) {
+        LogError("No hay memoria disponible.");
+        if (stream.file != stdout) {
+            fclose(stream.file);
+        }
+        DiscardStream();
+        return false;
+    }
+    state->emitStatement = StreamStatement;
+    Generator generator = {.output = stream.buffer, .symbols = state->symbols};
+    GeneratorProgramBegin(&generator);
+    return true;
+}
+
+static bool EndStream(const char * outputPath, bool succeed) {
+    if (succeed) {
+        Generator generator = {.output = stream.buffer, .symbols = state->symbols};
+        GeneratorProgramEnd(&generator);
+        stream.failed |= !outputBufferFlushToFile(stream.buffer, stream.file);
+    }
+    outputBufferDestroy(stream.buffer);
+    if (stream.file == stdout) {
+        return succeed && !stream.failed;
+    }
+    stream.failed |= fclose(stream.file) != 0;
+    if (!succeed || stream.failed || rename(stream.temporaryPath, outputPath) != 0) {
+        DiscardStream();
+        return false;
+    }
+    free(stream.temporaryPath);
+    stream.temporaryPath = NULL;
+    return true;
+}
+
+// Modo "--lex-only": solo ejecuta el analizador léxico y mide su rendimiento.
+static bool MeasureLexer() {
+    void * scanner = ScannerInit(state);
+    if (scanner == NULL) {
+        return false;
+    }
+    if (input == NULL) {
+        ScannerSetFile(scanner, stdin);
+    } else if (!ScannerSetBuffer(scanner, mappedFileData(input), mappedFileSize(input) + 2)) {
+        ScannerDestroy(scanner);
+        return false;
+    }
+    struct timespec start, end;
+    uint64_t tokens = 0;
+    YYSTYPE value;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (yylex(&value, scanner) != 0) {
+        tokens++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ScannerDestroy(scanner);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    if (seconds <= 0) {
+        seconds = 1e-9;
+    }
+    LogInfo("Tokens: %" PRIu64 " en %.3f s (%.0f tokens/s).", tokens, seconds, tokens / seconds);
+    if (input != NULL) {
+        LogInfo("Entrada: %" PRIu64 " bytes (%.1f MB/s).", mappedFileSize(input), mappedFileSize(input) / seconds / 1e6);
+    }
+    return true;
+}
 
 // Punto de entrada principal del compilador.
 const int main(const int argumentCount, const char ** arguments) {
-	// Inicializar estado de la aplicación.
-	state.program = NULL;
-	state.result = 0;
-	state.succeed = false;
+	// El nivel de log se aplica antes de mostrar nada.
+	for (int i = 1; i + 1 < argumentCount; ++i) {
+		if (strcmp(arguments[i], "--log-level") == 0 && !LogSetLevel(LogLevelFromName(arguments[i + 1]))) {
+			LogError("Nivel de log invalido o no compilado: '%s'.", arguments[i + 1]);
+			return 1;
+		}
+	}
 
 	// Mostrar parámetros recibidos por consola.
 	for (int i = 0; i < argumentCount; ++i) {
@@ -22,65 +289,226 @@ const int main(const int argumentCount, const char ** arguments) {
 	}
 
     bool testMode = false;
-    if (argumentCount == 2) {
-        char *test = "--test";
-        if (strcmp(arguments[1], test) == 0) {
+    bool streaming = false;
+    bool lexOnly = false;
+    bool batch = false;
+    bool watch = false;
+    // Programa a compilar. Si no se indica, se lee de la entrada estándar.
+    const char * inputPath = NULL;
+    // En modo "batch", todos los archivos y directorios indicados.
+    const char ** inputPaths = malloc(argumentCount * sizeof(char *));
+    int inputCount = 0;
+    // Destino del código generado: "-" es la salida estándar. Si no se indica,
+    // se escribe en el proyecto Maven y se compila y ejecuta con él.
+    const char * outputPath = NULL;
+    // Directorio de la caché de ASTs, si se indicó uno.
+    const char * cacheDirectory = NULL;
+    // Modo servidor: socket donde escuchar y cantidad de workers.
+    const char * socketPath = NULL;
+    int workers = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    for (int i = 1; i < argumentCount; ++i) {
+        if (strcmp(arguments[i], "--test") == 0) {
             testMode = true;
+        } else if (strcmp(arguments[i], "--stream") == 0) {
+            streaming = true;
+        } else if (strcmp(arguments[i], "--lex-only") == 0) {
+            lexOnly = true;
+        } else if (strcmp(arguments[i], "--output") == 0 && i + 1 < argumentCount) {
+            outputPath = arguments[++i];
+        } else if (strcmp(arguments[i], "--log-level") == 0 && i + 1 < argumentCount) {
+            // Ya aplicado.
+            i++;
+        } else if (strcmp(arguments[i], "--perf-counters") == 0) {
+            countersReport = true;
+        } else if (strcmp(arguments[i], "--mem-stats") == 0) {
+            memoryReport = true;
+        } else if (strcmp(arguments[i], "--time-report") == 0 && i + 1 < argumentCount) {
+            traceReportPath = arguments[++i];
+        } else if (strcmp(arguments[i], "--cache") == 0 && i + 1 < argumentCount) {
+            cacheDirectory = arguments[++i];
+        } else if (strcmp(arguments[i], "--batch") == 0) {
+            batch = true;
+        } else if (strcmp(arguments[i], "--watch") == 0) {
+            watch = true;
+        } else if (strcmp(arguments[i], "--serve") == 0 && i + 1 < argumentCount) {
+            socketPath = arguments[++i];
+        } else if (strcmp(arguments[i], "--workers") == 0 && i + 1 < argumentCount) {
+            workers = atoi(arguments[++i]);
+        } else if (arguments[i][0] != '-') {
+            inputPath = arguments[i];
+            inputPaths[inputCount++] = arguments[i];
+        }
+    }
+    const char * targetPath = outputPath == NULL ? MAVEN_MAIN_PATH : outputPath;
+
+    if (socketPath != NULL) {
+        free(inputPaths);
+        const int served = ServeCompilations(socketPath, workers);
+        LogInfo("Fin.");
+        return served;
+    }
+    if (batch) {
+        const int compiled = CompileBatch(inputPaths, inputCount, outputPath, testMode, workers);
+        free(inputPaths);
+        LogInfo("Fin.");
+        return compiled;
+    }
+    free(inputPaths);
+    if (watch) {
+        if (inputPath == NULL) {
+            LogError("El modo --watch requiere un archivo de entrada.");
+            return 1;
         }
+        // No se ejecuta Maven: la salida se actualiza en cada cambio.
+        const int watched = WatchCompilation(inputPath, targetPath);
+        LogInfo("Fin.");
+        return watched == 0 ? 0 : 1;
     }
 
 	// Compilar el programa de entrada.
 	LogInfo("Compilando...\n");
-    symbolTableInit();
-	const int result = yyparse();
-	switch (result) {
-		case 0:
-			// La variable "succeed" es la que setea Bison al identificar el símbolo
-			// inicial de la gramática satisfactoriamente.
-			if (state.succeed) {
-				LogInfo("La compilacion fue exitosa.");
-
-                
-                if (testMode) {
-                    symbolTableDestroy();
-                    freeProgram(state.program);
-                    LogInfo("Fin.");
-                    return 0;
+    state = compilerInit();
+    if (state == NULL) {
+        LogError("No hay memoria disponible.");
+        return -1;
+    }
+    state->streaming = streaming;
+    state->workers = workers;
+    if (traceReportPath != NULL || countersReport) {
+        trace = traceInit(traceReportPath != NULL);
+        state->trace = trace;
+    }
+    if (countersReport) {
+        const char * reason = NULL;
+        counters = perfCountersOpen(&reason);
+        if (counters == NULL) {
+            LogError("Contadores de hardware no disponibles: %s. Solo se informan los tiempos.", reason);
+        }
+        traceUseCounters(trace, counters);
+    }
+    traceBegin(trace, "Compilador");
+    if (inputPath != NULL) {
+        // El archivo se escanea directamente sobre el mapeo, sin copiarlo.
+        traceBegin(trace, "Lectura de la entrada");
+        input = mappedFileOpen(inputPath);
+        traceEnd(trace);
+        if (input == NULL) {
+            LogError("No se pudo leer el archivo '%s'.", inputPath);
+            DestroyCompiler();
+            return -1;
+        }
+        if (countersReport && !lexOnly) {
+            ScanSeparately();
+        }
+    }
+    if (lexOnly) {
+        const bool measured = MeasureLexer();
+        if (!measured) {
+            LogError("No se pudo crear el scanner.");
+        }
+        DestroyCompiler();
+        LogInfo("Fin.");
+        return measured ? 0 : -1;
+    }
+    if (streaming && !testMode && !BeginStream(targetPath)) {
+        LogError("No se pudo abrir la salida '%s'.", targetPath);
+        DestroyCompiler();
+        return -1;
+    }
+    CompilerStatus status;
+    if (input != NULL) {
+        if (cacheDirectory != NULL && mkdir(cacheDirectory, 0777) != 0 && errno != EEXIST) {
+            LogError("No se pudo crear la cache '%s'.", cacheDirectory);
+        }
+        status = compilerParseBufferCached(state, mappedFileData(input), mappedFileSize(input) + 2, cacheDirectory);
+    } else {
+        status = compilerParseFile(state, stdin);
+    }
+    if (streaming && !testMode && !EndStream(targetPath, status == COMPILER_OK)) {
+        if (status == COMPILER_OK) {
+            LogError("No se pudo escribir el codigo generado.");
+            DestroyCompiler();
+            return -1;
+        }
+    }
+    switch (status) {
+        case COMPILER_OK:
+            LogInfo("La compilacion fue exitosa.");
+
+            if (testMode) {
+                break;
+            }
+
+            if (!streaming) {
+                outputBufferADT output = outputBufferInit(0);
+                if (output == NULL) {
+                    LogError("No hay memoria disponible.");
+                    DestroyCompiler();
+                    return -1;
                 }
-                
-                FILE * file = fopen("./src/backend/domain-specific/src/main/java/Main.java", "w");
-
-                SetOutputFile(file);
-
-				GeneratorProgram(state.program);
-
-                fclose(file);
-
-                LogInfo("El archivo Main.java fue generado exitosamente.");
-
-                // Compile the generated file
-                system("mvn -f ./src/backend/domain-specific/pom.xml clean compile");
-                
-                // Run the generated file
-                system("mvn -f ./src/backend/domain-specific/pom.xml exec:java -Dexec.mainClass=\"Main\"");
-			}
-			else {
-				LogError("Se produjo un error en la aplicacion.");
-                symbolTableDestroy();
-				return -1;
-			}
-			break;
-		case 1:
-			LogError("Bison finalizo debido a un error de sintaxis.");
-			break;
-		case 2:
-			LogError("Bison finalizo abruptamente debido a que ya no hay memoria disponible.");
-			break;
-		default:
-			LogError("Error desconocido mientras se ejecutaba el analizador Bison (codigo %d).", result);
-	}
-    symbolTableDestroy();
-    freeProgram(state.program);
-	LogInfo("Fin.");
-	return result;
+                if (compilerGenerate(state, output) != COMPILER_OK) {
+                    LogError("No se pudo generar el codigo: %s", state->errorMessage);
+                    outputBufferDestroy(output);
+                    DestroyCompiler();
+                    return -1;
+                }
+
+                traceBegin(trace, "Escritura de la salida");
+                bool written;
+                if (strcmp(targetPath, "-") == 0) {
+                    written = outputBufferFlushToDescriptor(output, STDOUT_FILENO);
+                } else {
+                    written = outputBufferFlushToPath(output, targetPath);
+                }
+                outputBufferDestroy(output);
+                traceEnd(trace);
+
+                if (!written) {
+                    LogError("No se pudo escribir el codigo generado.");
+                    DestroyCompiler();
+                    return -1;
+                }
+            }
+
+            if (outputPath != NULL) {
+                break;
+            }
+
+            LogInfo("El archivo Main.java fue generado exitosamente.");
+
+            // Compile the generated file
+            traceBegin(trace, "mvn clean compile");
+            system("mvn -f ./src/backend/domain-specific/pom.xml clean compile");
+            traceEnd(trace);
+
+            // Run the generated file
+            traceBegin(trace, "mvn exec:java");
+            system("mvn -f ./src/backend/domain-specific/pom.xml exec:java -Dexec.mainClass=\"Main\"");
+            traceEnd(trace);
+            break;
+        case COMPILER_SYNTAX_ERROR:
+            LogError("%s", state->errorMessage);
+            LogError("Bison finalizo debido a un error de sintaxis.");
+            break;
+        case COMPILER_SEMANTIC_ERROR:
+            LogError("%s", state->errorMessage);
+            break;
+        case COMPILER_OUT_OF_MEMORY:
+            LogError("Bison finalizo abruptamente debido a que ya no hay memoria disponible.");
+            break;
+        default:
+            LogError("%s", state->errorMessage);
+    }
+    DestroyCompiler();
+    LogInfo("Fin.");
+    // Se conservan los códigos de salida de Bison: 1 para errores del programa
+    // de entrada y 2 cuando se agota la memoria.
+    switch (status) {
+        case COMPILER_OK:
+            return 0;
+        case COMPILER_OUT_OF_MEMORY:
+            return 2;
+        default:
+            return 1;
+    }
 }
@@ -0,0 +1,275 @@
+#include "server.h"
+#include "compiler.h"
+#include "backend/support/logger.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Tamaño inicial del buffer de entrada de cada worker, y máximo aceptado.
+#define SERVER_INPUT_SIZE (64 * 1024)
+#define SERVER_INPUT_LIMIT (64 * 1024 * 1024)
+
+// Conexiones en espera de ser aceptadas.
+#define SERVER_BACKLOG 128
+
+// Segundos que puede bloquearse una lectura o escritura de un cliente.
+#define SERVER_TIMEOUT_SECONDS 30
+
+// Estado compartido por los workers: al detenerse, el servidor corta las
+// conexiones en curso para que ningún worker quede bloqueado.
+typedef struct {
+	pthread_mutex_t lock;
+	bool stopping;
+} Server;
+
+// Buffers propios de cada worker, que se reutilizan entre conexiones.
+// "client" es la conexión en curso (-1 si no hay), protegida por el lock.
+typedef struct {
+	Server * server;
+	int socket;
+	int client;
+	char * input;
+	size_t inputSize;
+	outputBufferADT output;
+} Worker;
+
+// Lee el programa completo, dejando libres los 2 '\0' que exige el scanner.
+// Devuelve la longitud leída, o -1 si la conexión falla o excede el límite.
+static ssize_t ReceiveProgram(Worker * worker, int client) {
+	size_t length = 0;
+	for (;;) {
+		if (length + 2 == worker->inputSize) {
+			if (worker->inputSize >= SERVER_INPUT_LIMIT) {
+				return -1;
+			}
+			char * grown = realloc(worker->input, worker->inputSize * 2);
+			if (grown == NULL) {
+				return -1;
+			}
+			worker->input = grown;
+			worker->inputSize *= 2;
+		}
+		ssize_t received = read(client, worker->input + length, worker->inputSize - 2 - length);
+		if (received == 0) {
+			break;
+		}
+		if (received < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		length += received;
+	}
+	worker->input[length] = '\0';
+	worker->input[length + 1] = '\0';
+	return length;
+}
+
+static void ServeConnection(Worker * worker, int client) {
+	outputBufferReset(worker->output);
+	ssize_t length = ReceiveProgram(worker, client);
+	if (length < 0) {
+		outputBufferFormat(worker->output, "ERROR %d 0\nNo se pudo recibir el programa.\n", COMPILER_IO_ERROR);
+		outputBufferFlushToDescriptor(worker->output, client);
+		return;
+	}
+
+	CompilerState * state = compilerInit();
+	CompilerStatus status = COMPILER_OUT_OF_MEMORY;
+	if (state != NULL) {
+		status = compilerParseBuffer(state, worker->input, length + 2);
+	}
+	if (status == COMPILER_OK) {
+		outputBufferString(worker->output, "OK\n");
+		status = compilerGenerate(state, worker->output);
+	}
+	if (status != COMPILER_OK) {
+		outputBufferReset(worker->output);
+		outputBufferFormat(worker->output, "ERROR %d %d\n%s\n", status,
+			state == NULL ? 0 : state->errorLine,
+			state == NULL ? "No hay memoria disponible." : state->errorMessage);
+	}
+	compilerDestroy(state);
+	outputBufferFlushToDescriptor(worker->output, client);
+}
+
+// Registra la conexión en curso, para que el servidor pueda cortarla al
+// detenerse. Si ya se está deteniendo, la corta en el momento.
+static void BeginConnection(Worker * worker, int client) {
+	const struct timeval timeout = {.tv_sec = SERVER_TIMEOUT_SECONDS};
+	setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+	pthread_mutex_lock(&worker->server->lock);
+	worker->client = client;
+	if (worker->server->stopping) {
+		shutdown(client, SHUT_RDWR);
+	}
+	pthread_mutex_unlock(&worker->server->lock);
+}
+
+// El descriptor se cierra con el lock tomado: así no se corta por error otra
+// conexión que reutilice el mismo número.
+static void EndConnection(Worker * worker) {
+	pthread_mutex_lock(&worker->server->lock);
+	close(worker->client);
+	worker->client = -1;
+	pthread_mutex_unlock(&worker->server->lock);
+}
+
+static void * RunWorker(void * argument) {
+	Worker * worker = argument;
+	for (;;) {
+		int client = accept(worker->socket, NULL, NULL);
+		if (client < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+			// El socket se cerró para detener el servidor.
+			break;
+		}
+		BeginConnection(worker, client);
+		ServeConnection(worker, client);
+		EndConnection(worker);
+	}
+	return NULL;
+}
+
+// Desbloquea los "accept" pendientes y corta las conexiones en curso: un
+// cliente que no termina de enviar su programa no demora la parada.
+static void StopWorkers(Server * server, int fd, Worker * workers, int started) {
+	pthread_mutex_lock(&server->lock);
+	server->stopping = true;
+	shutdown(fd, SHUT_RDWR);
+	for (int i = 0; i < started; ++i) {
+		if (workers[i].client >= 0) {
+			shutdown(workers[i].client, SHUT_RDWR);
+		}
+	}
+	pthread_mutex_unlock(&server->lock);
+}
+
+/**
+ * Libera la ruta del socket si la ocupa un socket que quedó de una ejecución
+ * anterior: uno al que nadie atiende. Cualquier otra cosa (un archivo, o el
+ * socket de un servidor que sigue activo) se conserva y el servidor no
+ * arranca.
+ */
+static bool RemoveStaleSocket(const struct sockaddr_un * address) {
+	struct stat info;
+	if (lstat(address->sun_path, &info) != 0) {
+		return errno == ENOENT;
+	}
+	if (!S_ISSOCK(info.st_mode)) {
+		LogError("'%s' existe y no es un socket.", address->sun_path);
+		return false;
+	}
+	int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (probe < 0) {
+		LogError("No se pudo crear el socket: %s.", strerror(errno));
+		return false;
+	}
+	const bool refused = connect(probe, (const struct sockaddr *) address, sizeof(*address)) != 0 && errno == ECONNREFUSED;
+	close(probe);
+	if (!refused) {
+		LogError("Ya hay un servidor escuchando en '%s'.", address->sun_path);
+		return false;
+	}
+	if (unlink(address->sun_path) != 0 && errno != ENOENT) {
+		LogError("No se pudo borrar el socket anterior '%s': %s.", address->sun_path, strerror(errno));
+		return false;
+	}
+	return true;
+}
+
+static int OpenSocket(const char * socketPath) {
+	struct sockaddr_un address = {.sun_family = AF_UNIX};
+	if (strlen(socketPath) >= sizeof(address.sun_path)) {
+		LogError("La ruta del socket '%s' es demasiado larga.", socketPath);
+		return -1;
+	}
+	strcpy(address.sun_path, socketPath);
+	if (!RemoveStaleSocket(&address)) {
+		return -1;
+	}
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		LogError("No se pudo crear el socket: %s.", strerror(errno));
+		return -1;
+	}
+	if (bind(fd, (struct sockaddr *) &address, sizeof(address)) != 0 || listen(fd, SERVER_BACKLOG) != 0) {
+		LogError("No se pudo escuchar en '%s': %s.", socketPath, strerror(errno));
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+int ServeCompilations(const char * socketPath, int workerCount) {
+	if (workerCount <= 0) {
+		workerCount = 1;
+	}
+
+	// Las señales de parada se atienden solo desde este hilo, con "sigwait";
+	// los workers heredan la máscara. Un cliente que cierra antes de leer la
+	// respuesta no debe terminar el proceso.
+	sigset_t stopSignals;
+	sigemptyset(&stopSignals);
+	sigaddset(&stopSignals, SIGINT);
+	sigaddset(&stopSignals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &stopSignals, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	int fd = OpenSocket(socketPath);
+	if (fd < 0) {
+		return -1;
+	}
+
+	Server server = {.lock = PTHREAD_MUTEX_INITIALIZER, .stopping = false};
+	Worker * workers = calloc(workerCount, sizeof(Worker));
+	pthread_t * threads = calloc(workerCount, sizeof(pthread_t));
+	int started = 0;
+	for (; workers != NULL && threads != NULL && started < workerCount; ++started) {
+		Worker * worker = &workers[started];
+		worker->server = &server;
+		worker->socket = fd;
+		worker->client = -1;
+		worker->inputSize = SERVER_INPUT_SIZE;
+		worker->input = malloc(worker->inputSize);
+		worker->output = outputBufferInit(0);
+		if (worker->input == NULL || worker->output == NULL || pthread_create(&threads[started], NULL, RunWorker, worker) != 0) {
+			free(worker->input);
+			outputBufferDestroy(worker->output);
+			break;
+		}
+	}
+
+	if (started > 0) {
+		LogInfo("Escuchando en '%s' con %d workers.", socketPath, started);
+		int received;
+		sigwait(&stopSignals, &received);
+		LogInfo("Deteniendo el servidor (senal %d).", received);
+	} else {
+		LogError("No se pudo iniciar ningun worker.");
+	}
+
+	StopWorkers(&server, fd, workers, started);
+	for (int i = 0; i < started; ++i) {
+		pthread_join(threads[i], NULL);
+		free(workers[i].input);
+		outputBufferDestroy(workers[i].output);
+	}
+	close(fd);
+	unlink(socketPath);
+	free(workers);
+	free(threads);
+	pthread_mutex_destroy(&server.lock);
+	return started > 0 ? 0 : -1;
+}
@@ -0,0 +1,26 @@
+#ifndef SERVER_HEADER
+#define SERVER_HEADER
+
+/**
+ * Modo servidor: un proceso residente que compila programas recibidos por un
+ * socket Unix, evitando pagar el arranque del proceso en cada compilación.
+ *
+ * Protocolo (una compilación por conexión):
+ *
+ *	1) El cliente envía el programa y cierra su extremo de escritura.
+ *	2) El servidor responde "OK\n" seguido del código Java generado, o bien
+ *		"ERROR <estado> <línea>\n<mensaje>\n", y cierra la conexión.
+ *
+ * Por ejemplo: "nc -U -N compiler.sock < programa.tla".
+ *
+ * Atiende con "workers" hilos creados de antemano, que comparten el socket
+ * y reutilizan sus buffers entre compilaciones. Devuelve recién al recibir
+ * SIGINT o SIGTERM, con 0 si el servidor pudo iniciarse.
+ *
+ * Una lectura o escritura de un cliente que se bloquea más de 30 segundos
+ * termina la conexión con un error. Al detenerse, se cortan también las
+ * conexiones en curso.
+ */
+int ServeCompilations(const char * socketPath, int workers);
+
+#endif
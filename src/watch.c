@@ -0,0 +1,458 @@
+#include "watch.h"
+#include "compiler.h"
+#include "backend/code-generation/generator.h"
+#include "backend/support/logger.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Los editores suelen guardar en varios pasos (truncar, escribir, renombrar):
+// se espera este lapso sin eventos antes de recompilar.
+#define WATCH_SETTLE_MILLISECONDS 50
+
+// Tamaño inicial de los buffers de entrada y salida.
+#define WATCH_BUFFER_SIZE (64 * 1024)
+
+// Buffer que crece a medida que se necesita y se reutiliza entre cambios.
+typedef struct {
+	char * data;
+	uint64_t length;
+	uint64_t capacity;
+} Bytes;
+
+// Una sentencia de primer nivel del último programa compilado.
+typedef struct {
+	StatementList statement;
+	// La tabla de símbolos tal como la dejó.
+	SymbolTableMark mark;
+	// Dónde termina en el fuente, hasta dónde se leyó el fuente para
+	// reconocerla (UINT64_MAX: hasta el final) y dónde termina su código.
+	uint64_t end;
+	uint64_t read;
+	uint64_t output;
+} Checkpoint;
+
+typedef struct {
+	const char * inputPath;
+	const char * outputPath;
+	// El fuente leído (que Flex modifica al analizarlo) y una copia del último
+	// que se compiló, para no recompilar si el archivo se guardó sin cambios.
+	Bytes input;
+	Bytes compiled;
+	bool attempted;
+	// El análisis de "compiled" si fue exitoso (si no, NULL), y sus sentencias
+	// de primer nivel, en orden. Si faltó memoria para registrarlas, "lost".
+	CompilerState * state;
+	Checkpoint * checkpoints;
+	uint64_t checkpointCount;
+	uint64_t checkpointsSize;
+	bool lost;
+	// Desplazamiento en el fuente del buffer que se está analizando, y bytes
+	// analizados desde el último análisis completo.
+	uint64_t base;
+	uint64_t reparsed;
+	// El contenido actual de "outputPath" y el código generado.
+	Bytes previous;
+	outputBufferADT next;
+} Watch;
+
+static double Now() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static bool Reserve(Bytes * bytes, uint64_t capacity) {
+	if (capacity <= bytes->capacity) {
+		return true;
+	}
+	uint64_t grown = bytes->capacity == 0 ? WATCH_BUFFER_SIZE : bytes->capacity;
+	while (grown < capacity) {
+		grown *= 2;
+	}
+	char * data = realloc(bytes->data, grown);
+	if (data == NULL) {
+		return false;
+	}
+	bytes->data = data;
+	bytes->capacity = grown;
+	return true;
+}
+
+/**
+ * Lee el archivo completo desde el inicio, dejando "padding" bytes en cero al
+ * final. Se lee en lugar de mapearlo: un editor que trunca el archivo mientras
+ * se analiza provocaría un SIGBUS.
+ */
+static bool ReadAll(int fd, Bytes * bytes, uint64_t padding) {
+	bytes->length = 0;
+	for (;;) {
+		if (!Reserve(bytes, bytes->length + padding + 1)) {
+			errno = ENOMEM;
+			return false;
+		}
+		ssize_t received = pread(fd, bytes->data + bytes->length, bytes->capacity - padding - bytes->length, bytes->length);
+		if (received == 0) {
+			break;
+		}
+		if (received < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		bytes->length += received;
+	}
+	memset(bytes->data + bytes->length, 0, padding);
+	return true;
+}
+
+static bool WriteRange(int fd, const char * data, uint64_t from, uint64_t to) {
+	while (from < to) {
+		ssize_t written = pwrite(fd, data + from, to - from, from);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		from += written;
+	}
+	return true;
+}
+
+/**
+ * Escribe en la salida solo lo que difiere de su contenido actual: el prefijo
+ * común se conserva y, si el largo no cambió, también el sufijo común. Se
+ * compara con lo que hay en el archivo, de modo que un cambio hecho por otro
+ * medio también se corrige. Devuelve 0, o el "errno" del fallo.
+ */
+static int UpdateOutput(Watch * watch) {
+	const char * next = outputBufferData(watch->next);
+	uint64_t nextLength = outputBufferLength(watch->next);
+
+	int fd = open(watch->outputPath, O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		return errno;
+	}
+	if (!ReadAll(fd, &watch->previous, 0)) {
+		const int error = errno;
+		close(fd);
+		return error;
+	}
+	const char * previous = watch->previous.data;
+	uint64_t previousLength = watch->previous.length;
+	uint64_t from = 0;
+	uint64_t to = nextLength;
+	uint64_t common = previousLength < nextLength ? previousLength : nextLength;
+	while (from < common && previous[from] == next[from]) {
+		from++;
+	}
+	if (previousLength == nextLength) {
+		while (to > from && previous[to - 1] == next[to - 1]) {
+			to--;
+		}
+	}
+	int error = 0;
+	if (!WriteRange(fd, next, from, to) || (previousLength != nextLength && ftruncate(fd, nextLength) != 0)) {
+		error = errno;
+	}
+	if (close(fd) != 0 && error == 0) {
+		error = errno;
+	}
+	if (error == 0) {
+		if (from == to && previousLength == nextLength) {
+			LogInfo("El codigo generado no cambio.");
+		} else {
+			LogInfo("Se reescribieron %" PRIu64 " de %" PRIu64 " bytes de '%s'.", to - from, nextLength, watch->outputPath);
+		}
+	}
+	return error;
+}
+
+// Registra cada sentencia de primer nivel a medida que se analiza.
+static void AddStatement(CompilerState * state, StatementList statement, size_t end, size_t read) {
+	Watch * watch = state->emitData;
+	if (watch->lost) {
+		return;
+	}
+	if (watch->checkpointCount == watch->checkpointsSize) {
+		const uint64_t size = watch->checkpointsSize == 0 ? 1024 : 2 * watch->checkpointsSize;
+		Checkpoint * checkpoints = realloc(watch->checkpoints, size * sizeof(Checkpoint));
+		if (checkpoints == NULL) {
+			watch->lost = true;
+			return;
+		}
+		watch->checkpoints = checkpoints;
+		watch->checkpointsSize = size;
+	}
+	watch->checkpoints[watch->checkpointCount++] = (Checkpoint) {
+		.statement = statement,
+		.mark = symbolTableMark(state->symbols),
+		.end = end == SIZE_MAX ? UINT64_MAX : watch->base + end,
+		.read = read == SIZE_MAX ? UINT64_MAX : watch->base + read
+	};
+}
+
+/**
+ * Cantidad de sentencias del programa anterior que el nuevo conserva tal cual:
+ * las que se reconocieron leyendo solo de los primeros "common" bytes, que
+ * ambos fuentes comparten. También debe coincidir el byte que sigue al último
+ * leído, porque podría extender ese lexema ("<" y "<=").
+ */
+static uint64_t Reusable(const Watch * watch, uint64_t common) {
+	uint64_t low = 0;
+	uint64_t high = watch->checkpointCount;
+	while (low < high) {
+		const uint64_t middle = low + (high - low) / 2;
+		if (watch->checkpoints[middle].read < common) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+// Genera el código desde "statement", la sentencia número "index" del
+// programa, hasta el cierre, y registra dónde termina el de cada una.
+static bool Generate(Watch * watch, StatementList statement, uint64_t index) {
+	Generator generator = {.output = watch->next, .symbols = watch->state->symbols};
+	for (; statement != NULL && !GeneratorFailed(&generator); statement = statement->next, index++) {
+		GeneratorStatement(&generator, &statement->statement);
+		if (index < watch->checkpointCount) {
+			watch->checkpoints[index].output = outputBufferLength(watch->next);
+		}
+	}
+	GeneratorProgramEnd(&generator);
+	return !GeneratorFailed(&generator);
+}
+
+// Vuelve a analizar y generar lo que sigue a las primeras "reusable"
+// sentencias del programa anterior.
+static CompilerStatus Resume(Watch * watch, uint64_t reusable, uint64_t length) {
+	const Checkpoint last = watch->checkpoints[reusable - 1];
+	watch->checkpointCount = reusable;
+	watch->base = last.end;
+	watch->reparsed += length - last.end;
+	CompilerStatus status = compilerResumeBuffer(watch->state, last.statement, last.mark, watch->input.data + last.end, length - last.end + 2);
+	if (status == COMPILER_OK) {
+		outputBufferTruncate(watch->next, last.output);
+		if (!Generate(watch, last.statement->next, reusable)) {
+			status = COMPILER_OUT_OF_MEMORY;
+		}
+	}
+	return status;
+}
+
+// Analiza y genera el programa completo con un estado nuevo.
+static CompilerStatus Compile(Watch * watch, uint64_t length) {
+	compilerDestroy(watch->state);
+	watch->state = compilerInit();
+	if (watch->state == NULL) {
+		return COMPILER_OUT_OF_MEMORY;
+	}
+	symbolTableTrackChanges(watch->state->symbols);
+	watch->state->addStatement = AddStatement;
+	watch->state->emitData = watch;
+	watch->checkpointCount = 0;
+	watch->lost = false;
+	watch->base = 0;
+	watch->reparsed = length;
+	// Un análisis retomado que falló pudo dejar marcas de Flex en la entrada.
+	memcpy(watch->input.data, watch->compiled.data, length);
+	CompilerStatus status = compilerParseBuffer(watch->state, watch->input.data, length + 2);
+	if (status == COMPILER_OK) {
+		outputBufferReset(watch->next);
+		Generator generator = {.output = watch->next, .symbols = watch->state->symbols};
+		GeneratorProgramBegin(&generator);
+		if (watch->lost) {
+			watch->checkpointCount = 0;
+		}
+		if (!Generate(watch, watch->state->program->statements, 0)) {
+			status = COMPILER_OUT_OF_MEMORY;
+		}
+	}
+	return status;
+}
+
+/**
+ * Se conserva el análisis del último programa compilado. Si el cambio deja
+ * intactas las primeras sentencias de primer nivel, se conservan su AST, sus
+ * símbolos y su código, y solo se analiza y genera lo que sigue. Un análisis
+ * retomado que falla se repite completo, para informar el error con su línea.
+ */
+static void Recompile(Watch * watch) {
+	const double start = Now();
+	int fd = open(watch->inputPath, O_RDONLY | O_CLOEXEC);
+	// El scanner requiere 2 '\0' al final del buffer.
+	if (fd < 0 || !ReadAll(fd, &watch->input, 2)) {
+		const int error = errno;
+		LogError("No se pudo leer el archivo '%s': %s.", watch->inputPath, strerror(error));
+		if (fd >= 0) {
+			close(fd);
+		}
+		return;
+	}
+	close(fd);
+	const uint64_t length = watch->input.length;
+	if (watch->attempted && length == watch->compiled.length && memcmp(watch->input.data, watch->compiled.data, length) == 0) {
+		LogInfo("El programa no cambio.");
+		return;
+	}
+	uint64_t common = 0;
+	if (watch->state != NULL) {
+		const uint64_t shorter = length < watch->compiled.length ? length : watch->compiled.length;
+		while (common < shorter && watch->input.data[common] == watch->compiled.data[common]) {
+			common++;
+		}
+	}
+	if (!Reserve(&watch->compiled, length + 1)) {
+		LogError("No hay memoria disponible.");
+		compilerDestroy(watch->state);
+		watch->state = NULL;
+		return;
+	}
+	memcpy(watch->compiled.data, watch->input.data, length);
+	watch->compiled.length = length;
+	watch->attempted = true;
+
+	const uint64_t reusable = watch->state == NULL || watch->lost ? 0 : Reusable(watch, common);
+	// Los nodos descartados siguen en el arena del estado: se vuelve a empezar
+	// cuando lo reanalizado desde el último análisis completo supera el doble
+	// del fuente.
+	const bool resume = reusable > 0 && watch->reparsed + (length - watch->checkpoints[reusable - 1].end) <= 2 * length;
+	CompilerStatus status = resume ? Resume(watch, reusable, length) : COMPILER_OK;
+	const bool resumed = resume && status == COMPILER_OK;
+	if (!resumed) {
+		status = Compile(watch, length);
+	}
+	if (status != COMPILER_OK) {
+		if (watch->state == NULL) {
+			LogError("No hay memoria disponible.");
+		} else {
+			LogError("Rechazado (estado %d, linea %d): %s Se conserva la salida anterior.", status, watch->state->errorLine, watch->state->errorMessage);
+		}
+		compilerDestroy(watch->state);
+		watch->state = NULL;
+		return;
+	}
+	const int error = UpdateOutput(watch);
+	if (error != 0) {
+		LogError("No se pudo escribir '%s': %s.", watch->outputPath, strerror(error));
+		// Se reintenta en el próximo cambio aunque el fuente sea el mismo.
+		watch->attempted = false;
+	} else {
+		LogInfo("Compilado en %.3f s (%" PRIu64 " sentencias reutilizadas).", Now() - start, resumed ? reusable : 0);
+	}
+}
+
+// Indica si el evento corresponde al archivo vigilado.
+static bool Concerns(const char * events, ssize_t length, const char * name) {
+	for (ssize_t offset = 0; offset < length;) {
+		const struct inotify_event * event = (const struct inotify_event *) (events + offset);
+		if (event->len > 0 && strcmp(event->name, name) == 0) {
+			return true;
+		}
+		offset += sizeof(struct inotify_event) + event->len;
+	}
+	return false;
+}
+
+int WatchCompilation(const char * inputPath, const char * outputPath) {
+	// Se vigila el directorio: muchos editores reemplazan el archivo al guardar.
+	char * directory = strdup(inputPath);
+	char * slash = directory == NULL ? NULL : strrchr(directory, '/');
+	const char * name = slash == NULL ? inputPath : inputPath + (slash - directory) + 1;
+	if (directory != NULL) {
+		if (slash == NULL) {
+			strcpy(directory, ".");
+		} else if (slash == directory) {
+			slash[1] = '\0';
+		} else {
+			*slash = '\0';
+		}
+	}
+
+	sigset_t stopSignals;
+	sigemptyset(&stopSignals);
+	sigaddset(&stopSignals, SIGINT);
+	sigaddset(&stopSignals, SIGTERM);
+	sigprocmask(SIG_BLOCK, &stopSignals, NULL);
+	int signals = signalfd(-1, &stopSignals, SFD_CLOEXEC);
+	int notifier = inotify_init1(IN_CLOEXEC);
+	if (directory == NULL || signals < 0 || notifier < 0
+		|| inotify_add_watch(notifier, directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+		LogError("No se pudo vigilar '%s': %s.", inputPath, strerror(errno));
+		if (signals >= 0) {
+			close(signals);
+		}
+		if (notifier >= 0) {
+			close(notifier);
+		}
+		free(directory);
+		return -1;
+	}
+
+	Watch watch = {
+		.inputPath = inputPath,
+		.outputPath = outputPath,
+		.next = outputBufferInit(0)
+	};
+	if (watch.next == NULL) {
+		LogError("No hay memoria disponible.");
+		close(notifier);
+		close(signals);
+		free(directory);
+		return -1;
+	}
+	Recompile(&watch);
+	LogInfo("Vigilando '%s' (Ctrl+C para terminar).", inputPath);
+
+	char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	struct pollfd sources[] = {{.fd = notifier, .events = POLLIN}, {.fd = signals, .events = POLLIN}};
+	bool changed = false;
+	for (;;) {
+		// Con un cambio pendiente se espera a que el archivo se asiente.
+		int ready = poll(sources, 2, changed ? WATCH_SETTLE_MILLISECONDS : -1);
+		if (ready < 0 && errno != EINTR) {
+			break;
+		}
+		if (ready == 0) {
+			changed = false;
+			Recompile(&watch);
+			continue;
+		}
+		if (sources[1].revents & POLLIN) {
+			break;
+		}
+		if (sources[0].revents & POLLIN) {
+			ssize_t length = read(notifier, events, sizeof(events));
+			if (length > 0 && Concerns(events, length, name)) {
+				changed = true;
+			}
+		}
+	}
+
+	LogInfo("Fin de la vigilancia.");
+	compilerDestroy(watch.state);
+	free(watch.checkpoints);
+	outputBufferDestroy(watch.next);
+	free(watch.input.data);
+	free(watch.compiled.data);
+	free(watch.previous.data);
+	close(notifier);
+	close(signals);
+	free(directory);
+	return 0;
+}
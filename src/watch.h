@@ -0,0 +1,22 @@
+#ifndef WATCH_HEADER
+#define WATCH_HEADER
+
+/**
+ * Modo "watch": compila "inputPath" y vuelve a compilarlo cada vez que el
+ * archivo cambia, sin salir del proceso, hasta recibir SIGINT o SIGTERM.
+ *
+ * Las sentencias de primer nivel que preceden al primer byte modificado se
+ * conservan con su AST, sus símbolos y su código: solo se analiza y genera el
+ * resto del programa. Un archivo guardado sin cambios no se recompila. El
+ * código generado se compara con el contenido de "outputPath" y solo se
+ * reescribe el rango de bytes que difiere; si no cambió, el archivo no se
+ * toca. Un programa con errores se informa y deja la salida anterior intacta.
+ *
+ * La generación es secuencial: se registra dónde termina el código de cada
+ * sentencia para poder conservarlo.
+ *
+ * Devuelve 0 si la vigilancia pudo iniciarse.
+ */
+int WatchCompilation(const char * inputPath, const char * outputPath);
+
+#endif